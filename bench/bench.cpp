@@ -0,0 +1,230 @@
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include <fe/arena.h>
+#include <fe/fragments.h>
+#include <fe/loc.cpp.h>
+#include <fe/ring.h>
+#include <fe/scope_table.h>
+
+#include "bench.h"
+#include "corpus.h"
+#include "let.h"
+
+using namespace fe::bench;
+
+namespace {
+
+/// About 1MB of Let; if @p unicode, many subexpressions are quoted with `«»` and comments contain non-ASCII chars.
+std::string corpus(bool unicode) {
+    return Corpus({.seed = 23, .unicode = unicode ? .5 : 0., .comments = unicode ? .5 : 0.}).str();
+}
+
+/// @p num distinct strings - each @p len characters long unless @p num needs more base-62 digits.
+std::vector<std::string> strings(size_t num, size_t len) {
+    static constexpr std::string_view Digits = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::vector<std::string> res;
+    for (size_t i = 0; i != num; ++i) {
+        std::string s;
+        for (auto j = i; s.empty() || j != 0; j /= Digits.size()) s += Digits[j % Digits.size()];
+        s.resize(std::max(len, s.size()), '_'); // '_' is no digit: padding keeps the strings distinct
+        res.emplace_back(std::move(s));
+    }
+    return res;
+}
+
+/// Both benchmarks roll the Arena back every Chunk allocations: They measure the bump pointer - not page faults.
+void bench_arena(Bench& bench) {
+    static constexpr uint64_t Chunk = 4096; // at most 4096 * 13 * 8 bytes < 1 page
+
+    bench.run("Arena/allocate/16", [](uint64_t n) {
+        fe::Arena arena;
+        auto state = arena.state();
+        for (uint64_t i = 0; i != n; ++i) {
+            if (i % Chunk == 0) arena.deallocate(state);
+            do_not_optimize(arena.allocate(16));
+        }
+        return n * 16;
+    });
+    bench.run("Arena/allocate<uint64_t>/mixed", [](uint64_t n) {
+        fe::Arena arena;
+        auto state     = arena.state();
+        uint64_t bytes = 0;
+        for (uint64_t i = 0; i != n; ++i) {
+            if (i % Chunk == 0) arena.deallocate(state);
+            auto num = 1 + i % 13;
+            do_not_optimize(arena.allocate<uint64_t>(num));
+            bytes += num * sizeof(uint64_t);
+        }
+        return bytes;
+    });
+}
+
+void bench_sym(Bench& bench) {
+    // "short" fits into the Sym itself and never touches the pool; 1 << 20 strings need 4 base-62 digits.
+    static constexpr size_t Short = fe::Sym::Short_String_Bytes - 2;
+    // clang-format off
+    struct { const char* name; size_t num, len; } configs[] = {
+        {"SymPool/sym/short",     1 << 20, Short},
+        {"SymPool/sym/long",      1 << 16, 64},
+        {"SymPool/sym/duplicate",      64, 12},
+    };
+    // clang-format on
+
+    for (auto [name, num, len] : configs) {
+        bench.run(name, [strs = strings(num, len)](uint64_t n) {
+            fe::SymPool pool;
+            uint64_t bytes = 0;
+            for (uint64_t i = 0; i != n; ++i) {
+                const auto& s = strs[i % strs.size()];
+                do_not_optimize(pool.sym(s));
+                bytes += s.size();
+            }
+            return bytes;
+        });
+    }
+}
+
+void bench_utf8(Bench& bench) {
+    for (bool unicode : {false, true}) {
+        bench.run(unicode ? "utf8/decode/unicode" : "utf8/decode/ascii", [text = corpus(unicode)](uint64_t n) {
+            for (uint64_t i = 0; i != n; ++i) {
+                std::istringstream is(text);
+                while (fe::utf8::decode(is) != fe::utf8::EoF) {}
+            }
+            return n * text.size();
+        });
+    }
+}
+
+void bench_lexer(Bench& bench) {
+    for (bool unicode : {false, true}) {
+        bench.run(unicode ? "Lexer/lex/unicode" : "Lexer/lex/ascii", [text = corpus(unicode)](uint64_t n) {
+            for (uint64_t i = 0; i != n; ++i) {
+                fe::Driver driver;
+                std::istringstream is(text);
+                Lexer lexer(driver, is);
+                while (lexer.lex().tag() != Tok::Tag::EoF) {}
+            }
+            return n * text.size();
+        });
+    }
+}
+
+void bench_ring(Bench& bench) {
+    bench.run("Ring/put+access/1", [](uint64_t n) {
+        fe::Ring<uint64_t, 1> ring;
+        ring[0] = 0;
+        for (uint64_t i = 0; i != n; ++i) do_not_optimize(ring.put(ring[0] + i));
+        return uint64_t(0);
+    });
+    bench.run("Ring/put+access/3", [](uint64_t n) {
+        fe::Ring<uint64_t, 3> ring{0, 0, 0};
+        for (uint64_t i = 0; i != n; ++i) do_not_optimize(ring.put(ring[0] + ring[1] + ring[2] + i));
+        return uint64_t(0);
+    });
+}
+
+/// Enters 8 nested scopes with 4 bindings each - out of 64 names - looks up all names, and leaves the scopes again:
+/// a fe::ScopeTable vs. the usual stack of SymMap%s.
+void bench_scopes(Bench& bench) {
+    static constexpr int Depth = 8, Width = 4, Names = 64;
+
+    bench.run("ScopeTable/nest", [](uint64_t n) {
+        fe::SymPool pool;
+        std::vector<fe::Sym> syms;
+        for (const auto& s : strings(Names, 12)) syms.emplace_back(pool.sym(s));
+
+        fe::ScopeTable<const fe::Sym*> scopes;
+        for (uint64_t i = 0; i != n; ++i) {
+            for (int d = 0; d != Depth; ++d) {
+                scopes.push();
+                for (int w = 0; w != Width; ++w) {
+                    auto& sym = syms[(i + d * Width + w) % Names];
+                    scopes.bind(sym, &sym);
+                }
+            }
+            for (auto sym : syms) do_not_optimize(scopes.find(sym));
+            for (int d = 0; d != Depth; ++d) scopes.pop();
+        }
+        return 0;
+    });
+    bench.run("ScopeTable/nest/SymMap-stack", [](uint64_t n) {
+        fe::SymPool pool;
+        std::vector<fe::Sym> syms;
+        for (const auto& s : strings(Names, 12)) syms.emplace_back(pool.sym(s));
+
+        std::vector<fe::SymMap<const fe::Sym*>> scopes;
+        for (uint64_t i = 0; i != n; ++i) {
+            for (int d = 0; d != Depth; ++d) {
+                auto& scope = scopes.emplace_back();
+                for (int w = 0; w != Width; ++w) {
+                    auto& sym = syms[(i + d * Width + w) % Names];
+                    scope.emplace(sym, &sym);
+                }
+            }
+            for (auto sym : syms) {
+                const fe::Sym* res = nullptr;
+                for (auto scope = scopes.rbegin(); scope != scopes.rend() && !res; ++scope)
+                    if (auto j = scope->find(sym); j != scope->end()) res = j->second;
+                do_not_optimize(res);
+            }
+            for (int d = 0; d != Depth; ++d) scopes.pop_back();
+        }
+        return 0;
+    });
+}
+
+void bench_parser(Bench& bench) {
+    bench.run("Parser/let", [text = corpus(false)](uint64_t n) {
+        for (uint64_t i = 0; i != n; ++i) {
+            fe::Driver driver;
+            std::istringstream is(text);
+            do_not_optimize(Parser(driver, is).parse_prog());
+        }
+        return n * text.size();
+    });
+}
+
+/// Fragments::write - a single `write` of all fragments gathered - vs. one `write` per fragment into `/dev/null`.
+void bench_fragments(Bench& bench) {
+    static constexpr size_t Num = 1024;
+    auto fragments = std::make_shared<fe::Fragments>(Num);
+    fragments->render([](size_t i, fe::Writer& w, fe::Tab&) {
+        for (size_t j = 0, e = 4 + i % 32; j != e; ++j) w.outln("let x{}_{} = x{} + {};", i, j, j, i * j);
+    });
+    uint64_t size = 0;
+    for (size_t i = 0; i != Num; ++i) size += (*fragments)[i].view().size();
+
+    bench.run("Fragments/write", [fragments, size](uint64_t n) {
+        std::ofstream ofs("/dev/null");
+        for (uint64_t i = 0; i != n; ++i) fragments->write(ofs);
+        return n * size;
+    });
+    bench.run("Fragments/write/per-fragment", [fragments, size](uint64_t n) {
+        std::ofstream ofs("/dev/null");
+        for (uint64_t i = 0; i != n; ++i) {
+            for (size_t j = 0; j != Num; ++j) ofs.write((*fragments)[j].view().data(), (*fragments)[j].view().size());
+            ofs.flush();
+        }
+        return n * size;
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Bench bench(argc, argv);
+    bench_arena(bench);
+    bench_sym(bench);
+    bench_utf8(bench);
+    bench_lexer(bench);
+    bench_ring(bench);
+    bench_scopes(bench);
+    bench_parser(bench);
+    bench_fragments(bench);
+    bench.write_json();
+    auto res = bench.check_ratios();
+    return bench.check_baseline() == EXIT_SUCCESS ? res : EXIT_FAILURE;
+}
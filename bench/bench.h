@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fe/format.h>
+
+/// @file
+/// A tiny, self-contained microbenchmark harness.
+/// Each benchmark is run with an increasing number of iterations until it takes at least Bench::min_time;
+/// the results are printed as a table and - optionally - as JSON for tracking regressions between releases:
+/// ```
+/// fe-bench [--filter <substr>[,<substr>...]] [--min-time <seconds>] [--repetitions <n>] [--json <file>]
+///          [--max-ratio <name>:<reference>:<max>]... [--baseline <file> [--tolerance <fraction>] [--update-baseline]]
+/// ```
+/// Each benchmark reports the median of `--repetitions` runs and - if there is more than one - their spread.
+/// With `--max-ratio`, fe-bench fails if benchmark `<name>` takes more than `<max>` times as long per byte as
+/// benchmark `<reference>` - e.g. lexing vs. merely decoding the same text.
+/// Such a ratio hardly depends on the machine, so it works without a baseline.
+/// With `--baseline`, fe-bench compares its results against a JSON file previously written via `--json` or
+/// `--update-baseline` and fails if any benchmark got slower by more than `--tolerance` (default: `0.2`, i.e. 20%).
+/// Times are absolute, so only compare against a baseline recorded on the same machine with the same build.
+/// If the baseline doesn't exist, fe-bench merely notes that.
+namespace fe::bench {
+
+/// Prevents the compiler from optimizing away the computation of @p val.
+template<class T> inline void do_not_optimize(const T& val) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(val) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &val;
+#endif
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;     ///< Median of all `--repetitions`.
+    double bytes_per_sec; ///< `0` if the benchmark doesn't process bytes.
+    double min_ns_per_op = 0.;
+    double max_ns_per_op = 0.;
+};
+
+class Bench {
+public:
+    /// Runs `f(n)` which must perform @p n iterations and return the number of bytes processed (or `0`).
+    using Fn = std::function<uint64_t(uint64_t n)>;
+
+    Bench(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--filter" && i + 1 < argc) {
+                filters_.clear();
+                std::string_view filter = argv[++i];
+                for (size_t j = 0, k; j <= filter.size(); j = k + 1) {
+                    k = std::min(filter.find(',', j), filter.size());
+                    filters_.emplace_back(filter.substr(j, k - j));
+                }
+            } else if (arg == "--min-time" && i + 1 < argc) {
+                min_time_ = std::stod(argv[++i]);
+            } else if (arg == "--repetitions" && i + 1 < argc) {
+                repetitions_ = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--json" && i + 1 < argc) {
+                json_ = argv[++i];
+            } else if (arg == "--baseline" && i + 1 < argc) {
+                baseline_ = argv[++i];
+            } else if (arg == "--tolerance" && i + 1 < argc) {
+                tolerance_ = std::stod(argv[++i]);
+            } else if (arg == "--max-ratio" && i + 1 < argc) {
+                std::string_view ratio = argv[++i];
+                auto j = ratio.find(':'), k = ratio.rfind(':');
+                if (j == k) usage(argv[0]);
+                ratios_.emplace_back(std::string(ratio.substr(0, j)), std::string(ratio.substr(j + 1, k - j - 1)),
+                                     std::stod(std::string(ratio.substr(k + 1))));
+            } else if (arg == "--update-baseline") {
+                update_baseline_ = true;
+            } else {
+                usage(argv[0]);
+            }
+        }
+    }
+
+    /// Runs @p f and keeps the median of `--repetitions` - along with the fastest and the slowest run.
+    void run(std::string name, Fn f) {
+        if (std::ranges::none_of(filters_, [&](const auto& filter) { return name.find(filter) != std::string::npos; }))
+            return;
+
+        using Clock = std::chrono::steady_clock;
+        uint64_t n = 1, bytes;
+        double secs;
+        while (true) {
+            auto begin = Clock::now();
+            bytes      = f(n);
+            secs       = std::chrono::duration<double>(Clock::now() - begin).count();
+            if (secs >= min_time_ || n >= (uint64_t(1) << 40)) break;
+            // aim for 1.4 * min_time_ but grow at most 10x at once
+            auto next = secs > 0. ? uint64_t(double(n) * 1.4 * min_time_ / secs) : 10 * n;
+            n         = std::clamp(next, n + 1, 10 * n);
+        }
+        std::vector<double> times = {secs};
+        for (int i = 1; i < repetitions_; ++i) {
+            auto begin = Clock::now();
+            f(n);
+            times.emplace_back(std::chrono::duration<double>(Clock::now() - begin).count());
+        }
+        auto [min, max] = std::ranges::minmax(times);
+        auto median     = times.begin() + times.size() / 2;
+        std::ranges::nth_element(times, median);
+        secs = *median;
+
+        auto ns = [n](double secs) { return secs * 1e9 / double(n); };
+        auto& r = results_.emplace_back(std::move(name), n, ns(secs), double(bytes) / secs, ns(min), ns(max));
+        // spread of all repetitions relative to the median
+        auto spread = repetitions_ > 1 ? format::format(" ±{:>5.1f}%", 50. * (max - min) / secs) : std::string();
+        if (r.bytes_per_sec != 0.)
+            outln("{:<40} {:>14.2f} ns/op{} {:>12} ops {:>10.2f} MB/s", r.name, r.ns_per_op, spread, r.iterations,
+                  r.bytes_per_sec / 1e6);
+        else
+            outln("{:<40} {:>14.2f} ns/op{} {:>12} ops", r.name, r.ns_per_op, spread, r.iterations);
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+    /// Writes the results to `--json <file>`, if given.
+    void write_json() const {
+        if (!json_.empty()) write_json(json_);
+    }
+
+    /// Checks all `--max-ratio`s; both benchmarks of each must have run.
+    /// @returns `EXIT_FAILURE` if any ratio exceeds its maximum.
+    int check_ratios() const {
+        if (ratios_.empty()) return EXIT_SUCCESS;
+
+        int res = EXIT_SUCCESS;
+        outln("\n{:<40} {:>14} {:>14} {:>8}", "ratio", "reference", "now", "max");
+        for (const auto& [name, reference, max] : ratios_) {
+            auto r = std::ranges::find(results_, name, &Result::name);
+            auto b = std::ranges::find(results_, reference, &Result::name);
+            if (r == results_.end() || b == results_.end()) {
+                errln("error: '{}' or '{}' didn't run", name, reference);
+                res = EXIT_FAILURE;
+                continue;
+            }
+
+            // per byte - or per op if the benchmarks don't process bytes
+            auto per = [](const Result& r) { return r.bytes_per_sec != 0. ? 1e9 / r.bytes_per_sec : r.ns_per_op; };
+            auto ratio  = per(*r) / per(*b);
+            auto failed = ratio > max;
+            outln("{:<40} {:>14} {:>14.2f} {:>8.2f}{}", name, reference, ratio, max, failed ? "  REGRESSION" : "");
+            if (failed) res = EXIT_FAILURE;
+        }
+        return res;
+    }
+
+    /// Compares the results against `--baseline <file>`, if given - or overwrites it with `--update-baseline`.
+    /// @returns `EXIT_FAILURE` if any benchmark regressed by more than `--tolerance`.
+    int check_baseline() const {
+        if (baseline_.empty()) return EXIT_SUCCESS;
+
+        if (update_baseline_) {
+            write_json(baseline_);
+            outln("note: wrote baseline '{}'", baseline_);
+            return EXIT_SUCCESS;
+        }
+
+        if (!std::ifstream(baseline_)) {
+            outln("note: no baseline '{}'; record one with --update-baseline", baseline_);
+            return EXIT_SUCCESS;
+        }
+
+        auto base = read_json(baseline_);
+        if (base.empty()) {
+            errln("error: cannot read baseline '{}'", baseline_);
+            return EXIT_FAILURE;
+        }
+
+        int res = EXIT_SUCCESS;
+        outln("\n{:<40} {:>14} {:>14} {:>8}", "ns/op", "baseline", "now", "change");
+        for (const auto& b : base) {
+            auto r = std::ranges::find(results_, b.name, &Result::name);
+            if (r == results_.end()) continue; // filtered out
+
+            auto change = r->ns_per_op / b.ns_per_op - 1.;
+            auto failed = change > tolerance_;
+            outln("{:<40} {:>14.2f} {:>14.2f} {:>+7.1f}%{}", b.name, b.ns_per_op, r->ns_per_op, change * 100.,
+                  failed ? "  REGRESSION" : "");
+            if (failed) res = EXIT_FAILURE;
+        }
+        return res;
+    }
+
+private:
+    struct Ratio {
+        std::string name;
+        std::string reference;
+        double max;
+    };
+
+    [[noreturn]] static void usage(const char* prog) {
+        std::cerr << "usage: " << prog
+                  << " [--filter <substr>[,<substr>...]] [--min-time <seconds>] [--repetitions <n>] [--json <file>]"
+                     " [--max-ratio <name>:<reference>:<max>]..."
+                     " [--baseline <file> [--tolerance <fraction>] [--update-baseline]]\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    void write_json(const std::string& file) const {
+        std::ofstream ofs(file);
+        ofs << "{\n  \"benchmarks\": [\n";
+        for (auto sep = ""; const auto& r : results_) {
+            ofs << format::format(R"({}    {{"name": "{}", "iterations": {}, "ns_per_op": {}, "min_ns_per_op": {}, )"
+                                  R"("max_ns_per_op": {}, "bytes_per_second": {}}})",
+                                  sep, r.name, r.iterations, r.ns_per_op, r.min_ns_per_op, r.max_ns_per_op,
+                                  r.bytes_per_sec);
+            sep = ",\n";
+        }
+        ofs << "\n  ]\n}\n";
+    }
+
+    /// Reads what write_json wrote - this is not a general JSON parser.
+    static std::vector<Result> read_json(const std::string& file) {
+        std::vector<Result> res;
+        std::ifstream ifs(file);
+        for (std::string line; std::getline(ifs, line);) {
+            auto value = [&line](std::string_view key) -> std::string_view {
+                auto i = line.find(key);
+                if (i == std::string::npos) return {};
+                auto j = line.find_first_of(",}", i += key.size());
+                return std::string_view(line).substr(i, j - i);
+            };
+            auto name = value(R"("name": ")");
+            auto ns   = value(R"("ns_per_op": )");
+            if (name.empty() || ns.empty()) continue;
+            name.remove_suffix(1); // closing '"'
+            res.emplace_back(std::string(name), 0, std::stod(std::string(ns)), 0.);
+        }
+        return res;
+    }
+
+    std::vector<std::string> filters_ = {""};
+    std::string json_;
+    std::vector<Ratio> ratios_;
+    std::string baseline_;
+    double min_time_      = 0.5;
+    int repetitions_      = 1;
+    double tolerance_     = .2;
+    bool update_baseline_ = false;
+    std::vector<Result> results_;
+};
+
+} // namespace fe::bench
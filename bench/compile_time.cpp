@@ -0,0 +1,236 @@
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fe/format.h>
+
+#include "compile_time.h" // FE_CXX, FE_CXX_ID, FE_CXX_FLAGS, FE_INCLUDE_DIR, and FE_MODULE_SRC with FE_MODULE
+
+/// @file
+/// Measures how expensive it is to include each header of FE on its own:
+/// size of the preprocessed translation unit and wall time of a `-fsyntax-only` compile (best of `--runs`).
+/// Finally, it compares a translation unit with `#include <fe/fe.h>` with and without precompiled header and - if
+/// built with `-DFE_MODULE=ON` - with `import fe;` instead.
+/// ```
+/// fe-compile-time [--runs <n>] [--json <file>]
+/// ```
+/// Fails if a header exceeds its Budget.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Result {
+    std::string header;
+    size_t lines;
+    size_t bytes;
+    double ms;
+};
+
+/// The reference for the Budget%s: only the format library and the standard headers fe/format.h builds upon.
+constexpr std::string_view Std_TU = R"(#ifdef FE_STD_FORMAT_SUPPORT
+#    include <format>
+#else
+#    include <fmt/format.h>
+#endif
+#include <filesystem>
+#include <string>
+#include <string_view>
+)";
+
+/// The preprocessed size of @p header must not exceed @p factor times the one of Std_TU.
+/// Being relative, this holds on every toolchain - no matter which compiler, standard library, or format library.
+/// The factors are those of the tree before fe/diag.h existed (GCC 12, libstdc++ 12, fmt 9.1) - rounded up a bit as
+/// the ratios slightly differ between toolchains.
+struct Budget {
+    std::string_view header;
+    double factor;
+};
+
+constexpr Budget Budgets[] = {
+    {"fe/arena.h", 0.80},
+    {"fe/assert.h", 0.01},
+    {"fe/cast.h", 0.08}, // 0.003 before fe::visit, which needs <type_traits>
+    {"fe/driver.h", 1.27},
+    {"fe/enum.h", 0.10},
+    {"fe/format.h", 1.27},
+    {"fe/lexer.h", 1.09},
+    {"fe/loc.h", 1.08},
+    {"fe/parser.h", 1.09},
+    {"fe/ring.h", 0.36},
+    {"fe/sym.h", 0.92},
+    {"fe/utf8.h", 0.49},
+    {"fe/writer.h", 1.27}, // no more than fe/format.h
+};
+
+int run(const std::string& cmd) { return std::system(cmd.c_str()); }
+
+/// Best wall time of @p runs executions of @p cmd in ms.
+double time(const std::string& cmd, int runs) {
+    auto best = std::chrono::duration<double, std::milli>::max();
+    for (int i = 0; i != runs; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        if (run(cmd) != 0) throw std::runtime_error("failed: " + cmd);
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin));
+    }
+    return best.count();
+}
+
+/// Measures a translation unit with @p src; @p header is either a header of FE or `<empty>`/`<std>`.
+Result measure(const fs::path& dir, std::string header, std::string_view src, int runs) {
+    auto name = header.starts_with('<') ? header.substr(1, header.size() - 2) : fs::path(header).stem().string();
+    auto tu   = dir / (name + ".cpp");
+    auto ii   = dir / (name + ".ii");
+    std::ofstream(tu) << src;
+
+    auto cmd = fe::format::format("\"{}\" {} ", FE_CXX, FE_CXX_FLAGS);
+    if (run(fe::format::format("{} -E \"{}\" -o \"{}\"", cmd, tu.string(), ii.string())) != 0)
+        throw std::runtime_error("cannot preprocess " + header);
+
+    size_t lines = 0, bytes = fs::file_size(ii);
+    std::ifstream ifs(ii);
+    for (std::string line; std::getline(ifs, line);) ++lines;
+
+    auto ms = time(fe::format::format("{} -fsyntax-only \"{}\"", cmd, tu.string()), runs);
+    return {header, lines, bytes, ms};
+}
+
+/// Compiles `#include <fe/fe.h>` with a precompiled fe/fe.h.
+Result measure_pch(const fs::path& dir, int runs) {
+    std::string_view id = FE_CXX_ID;
+    auto tu             = dir / "pch.cpp";
+    std::ofstream(tu) << "#include <fe/fe.h>\n";
+
+    auto cmd = fe::format::format("\"{}\" {} ", FE_CXX, FE_CXX_FLAGS);
+    auto hdr = (dir / "pch.h").string(); // precompiling fe/fe.h directly warns about "#pragma once in main file"
+    std::ofstream(hdr) << "#include <fe/fe.h>\n";
+    if (id == "GNU") {
+        // GCC picks up <dir>/pch/fe/fe.h.gch instead of fe/fe.h as <dir>/pch comes first in the include path
+        fs::create_directories(dir / "pch" / "fe");
+        auto gch = (dir / "pch" / "fe" / "fe.h.gch").string();
+        if (run(fe::format::format("{} -x c++-header \"{}\" -o \"{}\"", cmd, hdr, gch)) != 0)
+            throw std::runtime_error("cannot precompile fe/fe.h");
+        cmd = fe::format::format("\"{}\" -I\"{}\" {} ", FE_CXX, (dir / "pch").string(), FE_CXX_FLAGS);
+    } else if (id.ends_with("Clang")) {
+        auto pch = (dir / "fe.pch").string();
+        if (run(fe::format::format("{} -x c++-header \"{}\" -o \"{}\"", cmd, hdr, pch)) != 0)
+            throw std::runtime_error("cannot precompile fe/fe.h");
+        cmd += fe::format::format("-include-pch \"{}\" ", pch);
+    } else {
+        throw std::runtime_error("don't know how to precompile headers with this compiler");
+    }
+
+    auto ms = time(fe::format::format("{} -fsyntax-only \"{}\"", cmd, tu.string()), runs);
+    return {"fe/fe.h (PCH)", 0, 0, ms};
+}
+
+#ifdef FE_MODULE_SRC
+/// Compiles `import fe;` with a precompiled modules/fe.cppm.
+Result measure_module(const fs::path& dir, int runs) {
+    std::string_view id = FE_CXX_ID;
+    auto tu             = dir / "module.cpp";
+    std::ofstream(tu) << "import fe;\n";
+
+    auto cmd = fe::format::format("\"{}\" {} ", FE_CXX, FE_CXX_FLAGS);
+    if (id == "GNU") {
+        // GCC writes and reads gcm.cache/fe.gcm relative to the working directory
+        cmd = fe::format::format("cd \"{}\" && {}-fmodules-ts ", dir.string(), cmd);
+        if (run(fe::format::format("{} -x c++ -c \"{}\" -o fe.o", cmd, FE_MODULE_SRC)) != 0)
+            throw std::runtime_error("cannot precompile modules/fe.cppm");
+    } else if (id.ends_with("Clang")) {
+        auto pcm = (dir / "fe.pcm").string();
+        if (run(fe::format::format("{} --precompile -x c++-module \"{}\" -o \"{}\"", cmd, FE_MODULE_SRC, pcm)) != 0)
+            throw std::runtime_error("cannot precompile modules/fe.cppm");
+        cmd += fe::format::format("-fmodule-file=fe=\"{}\" ", pcm);
+    } else {
+        throw std::runtime_error("don't know how to precompile modules with this compiler");
+    }
+
+    auto ms = time(fe::format::format("{} -fsyntax-only \"{}\"", cmd, tu.string()), runs);
+    return {"import fe;", 0, 0, ms};
+}
+#endif
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int runs = 3;
+    std::string json;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--runs <n>] [--json <file>]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<std::string> headers;
+    for (const auto& entry : fs::directory_iterator(fs::path(FE_INCLUDE_DIR) / "fe")) {
+        auto name = entry.path().filename().string();
+        if (name.ends_with(".h") && !name.ends_with(".cpp.h")) headers.emplace_back("fe/" + name);
+    }
+    std::ranges::sort(headers);
+
+    auto dir = fs::temp_directory_path() / "fe-compile-time";
+    fs::create_directories(dir);
+
+    std::vector<Result> results;
+    try {
+        fe::outln("{:<20} {:>10} {:>10} {:>10}", "header", "lines", "KB", "ms");
+        auto print = [](const Result& r) {
+            fe::outln("{:<20} {:>10} {:>10.1f} {:>10.1f}", r.header, r.lines, double(r.bytes) / 1024., r.ms);
+        };
+        print(results.emplace_back(measure(dir, "<empty>", "", runs)));
+        print(results.emplace_back(measure(dir, "<std>", Std_TU, runs)));
+        for (const auto& header : headers)
+            print(results.emplace_back(measure(dir, header, "#include <" + header + ">\n", runs)));
+        auto print_time = [](const Result& r) {
+            fe::outln("{:<20} {:>10} {:>10} {:>10.1f}", r.header, "-", "-", r.ms);
+        };
+        print_time(results.emplace_back(measure_pch(dir, runs)));
+#ifdef FE_MODULE_SRC
+        print_time(results.emplace_back(measure_module(dir, runs)));
+#endif
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    fs::remove_all(dir);
+
+    if (!json.empty()) {
+        std::ofstream ofs(json);
+        ofs << "{\n  \"headers\": [\n";
+        for (auto sep = ""; const auto& r : results) {
+            ofs << fe::format::format(R"({}    {{"name": "{}", "lines": {}, "bytes": {}, "ms": {}}})", sep, r.header,
+                                      r.lines, r.bytes, r.ms);
+            sep = ",\n";
+        }
+        ofs << "\n  ]\n}\n";
+    }
+
+    auto find = [&](std::string_view header) { return std::ranges::find(results, header, &Result::header); };
+    auto ref    = find("<std>");
+    int res     = EXIT_SUCCESS;
+    for (auto [header, factor] : Budgets) {
+        auto r = find(header);
+        if (r == results.end()) continue;
+        auto ratio = double(r->lines) / double(ref->lines);
+        fe::outln("{}: {} lines = {:.3f}x <std> (budget: {}x)", header, r->lines, ratio, factor);
+        if (ratio > factor) {
+            std::cerr << "error: " << header << " exceeds its budget\n";
+            res = EXIT_FAILURE;
+        }
+    }
+    return res;
+}
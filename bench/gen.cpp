@@ -0,0 +1,93 @@
+#include <cstdlib>
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "corpus.h"
+
+namespace {
+
+[[noreturn]] void usage(const char* prog) {
+    std::cerr << "usage: " << prog << " [options]\n"
+              << "Writes a random but syntactically valid Let program.\n\n"
+              << "  -o <file>           output file (default: stdout)\n"
+              << "  --seed <n>          same seed, same output (default: 0)\n"
+              << "  --size <n>[k|M|G]   approximate size in bytes (default: 1M)\n"
+              << "  --id <min>:<max>    identifier length range (default: 1:12)\n"
+              << "  --vocab <n>         number of distinct identifiers (default: 1024)\n"
+              << "  --depth <n>         maximum expression nesting depth (default: 4)\n"
+              << "  --unicode <p>       probability of non-ASCII constructs (default: 0)\n"
+              << "  --comments <p>      probability of a comment per statement (default: 0)\n";
+    std::exit(EXIT_FAILURE);
+}
+
+uint64_t str2size(std::string s) {
+    uint64_t factor = 1;
+    switch (s.empty() ? '\0' : s.back()) {
+        case 'k': factor = uint64_t(1) << 10; break;
+        case 'M': factor = uint64_t(1) << 20; break;
+        case 'G': factor = uint64_t(1) << 30; break;
+        default: break;
+    }
+    if (factor != 1) s.pop_back();
+
+    size_t pos;
+    auto res = std::stoull(s, &pos);
+    if (pos != s.size()) throw std::invalid_argument("size");
+    return factor * res;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Corpus::Config config;
+    std::string output;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 == argc) usage(argv[0]);
+            std::string val = argv[++i];
+
+            if (arg == "-o") {
+                output = val;
+            } else if (arg == "--seed") {
+                config.seed = std::stoull(val);
+            } else if (arg == "--size") {
+                config.size = str2size(val);
+            } else if (arg == "--id") {
+                auto colon    = val.find(':');
+                config.id_min = std::stoull(val.substr(0, colon));
+                config.id_max = colon == std::string::npos ? config.id_min : std::stoull(val.substr(colon + 1));
+            } else if (arg == "--vocab") {
+                config.vocab = std::stoull(val);
+            } else if (arg == "--depth") {
+                config.depth = std::stoull(val);
+            } else if (arg == "--unicode") {
+                config.unicode = std::stod(val);
+            } else if (arg == "--comments") {
+                config.comments = std::stod(val);
+            } else {
+                usage(argv[0]);
+            }
+        }
+    } catch (const std::logic_error&) { // std::invalid_argument or std::out_of_range
+        usage(argv[0]);
+    }
+    if (config.id_min == 0 || config.id_min > config.id_max || config.vocab == 0) usage(argv[0]);
+
+    std::ofstream ofs;
+    if (!output.empty()) {
+        ofs.open(output, std::ios::binary);
+        if (!ofs) {
+            std::cerr << "error: cannot write '" << output << "'\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    fe::Writer w(output.empty() ? std::cout : ofs);
+    Corpus(config).generate(w);
+}
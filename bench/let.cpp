@@ -0,0 +1,88 @@
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fe/format.h>
+#include <fe/loc.cpp.h>
+
+#include "let.h"
+
+/// @file
+/// Example driver for the Let language (see tests/let.h): parses each file and reports its throughput.
+/// This is what you would build with LTO and PGO for your own language; see CMakePresets.json and pgo.cmake.
+/// ```
+/// fe-let [--repeat <n>] [--trace <file>] <file>...
+/// ```
+/// With `-DFE_TRACE=ON`, `--trace` writes a Chrome trace with a span per phase; see fe/trace.h.
+
+int main(int argc, char** argv) {
+    int repeat = 1;
+    std::string trace;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace = argv[++i];
+        } else if (arg.starts_with('-')) {
+            files.clear();
+            break;
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--repeat <n>] [--trace <file>] <file>...\n";
+        return EXIT_FAILURE;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    size_t num_errors = 0;
+    for (const auto& file : files) {
+        std::string text;
+        {
+            FE_TRACE_SCOPE("fe-let: read");
+            std::ifstream ifs(file, std::ios::binary);
+            if (!ifs) {
+                std::cerr << "error: cannot read '" << file << "'\n";
+                return EXIT_FAILURE;
+            }
+            text.assign(std::istreambuf_iterator<char>(ifs), {});
+        }
+        std::filesystem::path path(file);
+
+        size_t num_nodes = 0;
+        auto best        = std::chrono::duration<double>::max();
+        for (int i = 0; i != repeat; ++i) {
+            FE_TRACE_SCOPE("fe-let: compile");
+            fe::Driver driver;
+            std::istringstream is(text);
+            auto begin = Clock::now();
+            num_nodes  = Parser(driver, is, &path).parse_prog(); // traced as "Parser::parse_prog"
+            best       = std::min(best, std::chrono::duration<double>(Clock::now() - begin));
+            if (i == 0) num_errors += driver.num_errors();
+        }
+
+        fe::outln("{}: {} bytes, {} nodes, {:.1f} ms, {:.1f} MB/s", file, text.size(), num_nodes, best.count() * 1e3,
+                  double(text.size()) / best.count() / 1e6);
+    }
+
+    if (!trace.empty()) {
+#ifdef FE_TRACE
+        std::ofstream ofs(trace);
+        fe::Trace::get().write(ofs);
+#else
+        std::cerr << "warning: --trace ignored; build with -DFE_TRACE=ON\n";
+#endif
+    }
+    return num_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
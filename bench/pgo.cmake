@@ -0,0 +1,79 @@
+# Builds fe-bench and fe-let via the presets in CMakePresets.json - release, lto, and pgo (LTO + PGO) -
+# trains the PGO build on generated Let programs, and reports the gains - medians along with their spread:
+#   cmake -P bench/pgo.cmake
+# Set CC/CXX in the environment to pick the compiler; the report ends up in build/pgo-report.md.
+cmake_minimum_required(VERSION 3.23)
+
+get_filename_component(src "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+set(build "${src}/build")
+set(benchmarks "Lexer,Parser,SymPool,utf8")
+
+function(run)
+    message(STATUS "${ARGN}")
+    execute_process(COMMAND ${ARGN} WORKING_DIRECTORY ${src} COMMAND_ERROR_IS_FATAL ANY)
+endfunction()
+
+function(build preset)
+    run(${CMAKE_COMMAND} --preset ${preset})
+    run(${CMAKE_COMMAND} --build --preset ${preset})
+endfunction()
+
+build(release)
+build(lto)
+
+# instrument & train: fe-bench on its own corpora, fe-let on generated programs
+file(REMOVE_RECURSE ${build}/pgo/pgo-profile)
+build(pgo-generate)
+run(${build}/pgo/bin/fe-bench --filter ${benchmarks} --min-time 0.05)
+run(${build}/pgo/bin/fe-gen --seed 1 --size 8M -o ${build}/pgo/train-ascii.let)
+run(${build}/pgo/bin/fe-gen --seed 2 --size 8M --unicode .5 --comments .5 -o ${build}/pgo/train-unicode.let)
+run(${build}/pgo/bin/fe-let ${build}/pgo/train-ascii.let ${build}/pgo/train-unicode.let)
+build(pgo-use)
+
+# A single run is noise-dominated: report the median of many repetitions along with the fastest and the slowest one.
+set(repetitions 15)
+foreach(preset release lto pgo)
+    run(${build}/${preset}/bin/fe-bench --filter ${benchmarks} --repetitions ${repetitions} --json ${build}/${preset}.json)
+    file(READ ${build}/${preset}.json json_${preset})
+endforeach()
+
+# math(EXPR) is integer only: use hundredths of a ns
+function(centi_ns json i key out)
+    string(JSON ns GET "${json}" benchmarks ${i} ${key})
+    string(REGEX MATCH "^[0-9]+" int "${ns}")
+    string(REGEX MATCH "\\.[0-9]*" frac "${ns}")
+    if(NOT frac)
+        set(frac ".")
+    endif()
+    string(SUBSTRING "${frac}00" 1 2 frac)
+    math(EXPR centi "${int}${frac}")
+    set(${out} ${centi} PARENT_SCOPE)
+    set(${out}_str "${int}.${frac}" PARENT_SCOPE)
+endfunction()
+
+set(report "Median ns/op of ${repetitions} repetitions; [fastest, slowest] in brackets.\n")
+string(APPEND report "If the brackets of release and lto + pgo overlap, the difference is within noise.\n\n")
+string(APPEND report "| ns/op | release | lto | lto + pgo | pgo vs. release |\n|---|---:|---:|---:|---:|\n")
+string(JSON num LENGTH "${json_release}" benchmarks)
+math(EXPR last "${num} - 1")
+foreach(i RANGE ${last})
+    string(JSON name GET "${json_release}" benchmarks ${i} name)
+    set(row "| ${name} ")
+    foreach(preset release lto pgo)
+        centi_ns("${json_${preset}}" ${i} ns_per_op med_${preset})
+        centi_ns("${json_${preset}}" ${i} min_ns_per_op min_${preset})
+        centi_ns("${json_${preset}}" ${i} max_ns_per_op max_${preset})
+        string(APPEND row "| ${med_${preset}_str} [${min_${preset}_str}, ${max_${preset}_str}] ")
+    endforeach()
+    math(EXPR speedup "100 * ${med_release} / ${med_pgo} - 100")
+    if(min_pgo GREATER max_release OR max_pgo LESS min_release)
+        string(APPEND row "| ${speedup}% |\n")
+    else()
+        string(APPEND row "| ${speedup}% (noise) |\n")
+    endif()
+    string(APPEND report "${row}")
+endforeach()
+
+file(WRITE ${build}/pgo-report.md "${report}")
+message("${report}")
+message(STATUS "Report written to ${build}/pgo-report.md")
@@ -0,0 +1 @@
+// Nothing to see here: fe-pch only exists to precompile fe/fe.h; see CMakeLists.txt.
@@ -0,0 +1,94 @@
+#include "budget.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <new>
+
+namespace fuzz {
+
+Allocs& Allocs::get() {
+    static Allocs allocs;
+    return allocs;
+}
+
+namespace {
+
+double time_scale() {
+    static double scale = [] {
+        auto env = std::getenv("FE_FUZZ_TIME_SCALE");
+        auto res = env ? std::strtod(env, nullptr) : 1.;
+        return res > 0. ? res : 1.;
+    }();
+    return scale;
+}
+
+[[noreturn]] void exceeded(const char* what, double spent, double budget, size_t size) {
+    std::fprintf(stderr, "==fuzz== %s budget exceeded: %.0f > %.0f for an input of %zu bytes\n", what, spent, budget,
+                 size);
+    std::abort(); // libFuzzer reports this as crash and saves the input
+}
+
+} // namespace
+
+Budget::Scope::~Scope() {
+    auto ns     = std::chrono::duration<double, std::nano>(Clock::now() - begin_).count();
+    auto num    = Allocs::get().num - allocs_.num;
+    auto bytes  = Allocs::get().bytes - allocs_.bytes;
+    auto max_ns = (budget_.ns_base + budget_.ns_per_byte * double(size_)) * time_scale();
+    auto max_num   = budget_.allocs_base + budget_.allocs_per_byte * size_;
+    auto max_bytes = budget_.bytes_base + budget_.bytes_per_byte * size_;
+
+    if (ns > max_ns) exceeded("time (ns)", ns, max_ns, size_);
+    if (num > max_num) exceeded("allocation", double(num), double(max_num), size_);
+    if (bytes > max_bytes) exceeded("allocated bytes", double(bytes), double(max_bytes), size_);
+}
+
+} // namespace fuzz
+
+#if defined(__SANITIZE_ADDRESS__)
+#    define FE_FUZZ_ASAN 1
+#elif defined(__has_feature)
+#    if __has_feature(address_sanitizer)
+#        define FE_FUZZ_ASAN 1
+#    endif
+#endif
+
+#ifdef FE_FUZZ_ASAN
+// ASan owns the global operator new/delete - replacing them clashes with its own.
+// Instead, count allocations via its malloc hook, which sees operator new as well.
+
+extern "C" int __sanitizer_install_malloc_and_free_hooks(void (*malloc_hook)(const volatile void*, size_t),
+                                                         void (*free_hook)(const volatile void*));
+
+namespace {
+
+void malloc_hook(const volatile void*, size_t n) {
+    auto& allocs = fuzz::Allocs::get();
+    ++allocs.num;
+    allocs.bytes += n;
+}
+
+void free_hook(const volatile void*) {} // ASan ignores a null hook
+
+[[maybe_unused]] const int installed = __sanitizer_install_malloc_and_free_hooks(malloc_hook, free_hook);
+
+} // namespace
+#else
+// Replace the global operator new/delete to count allocations.
+// The aligned and nothrow variants are not used by FE and hence, not counted.
+
+void* operator new(size_t n) {
+    auto& allocs = fuzz::Allocs::get();
+    ++allocs.num;
+    allocs.bytes += n;
+    if (auto ptr = std::malloc(n ? n : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <chrono>
+#include <string_view>
+
+/// @file
+/// Per-input resource budget for the fuzz targets.
+/// Crashes are not the only bugs a fuzzer can find: An input that makes FE do superlinear work - or allocate
+/// superlinear memory - is a bug, too.
+/// Therefore, each target wraps the code under test into a Budget::Scope that aborts as soon as the time or
+/// the number of allocations/allocated bytes exceeds a budget that is *linear* in the size of the input.
+/// ```
+/// {
+///     fuzz::Budget::Scope scope(Budget, size);
+///     /* code under test */
+/// }
+/// /* check invariants - not accounted for */
+/// ```
+/// Set `FE_FUZZ_TIME_SCALE` in the environment to scale all time budgets, e.g. on slow or heavily loaded machines.
+
+namespace fuzz {
+
+/// Number of calls to and bytes requested from the global `operator new` since program start.
+/// budget.cpp replaces `operator new` to keep track of these - or, under ASan, installs a malloc hook that also counts
+/// plain `malloc`s.
+struct Allocs {
+    size_t num   = 0;
+    size_t bytes = 0;
+
+    static Allocs& get();
+};
+
+struct Budget {
+    // clang-format off
+    double ns_base;        ///< Time for an empty input.
+    double ns_per_byte;    ///< Additional time per input byte.
+    size_t allocs_base;    ///< Allocations for an empty input.
+    size_t allocs_per_byte;
+    size_t bytes_base;     ///< Allocated bytes for an empty input.
+    size_t bytes_per_byte;
+    // clang-format on
+
+    /// Checks this Budget against the resources spent during the lifetime of a Scope.
+    class Scope {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        Scope(const Budget& budget, size_t size)
+            : budget_(budget)
+            , size_(size)
+            , allocs_(Allocs::get())
+            , begin_(Clock::now()) {}
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+    private:
+        const Budget& budget_;
+        size_t size_;
+        Allocs allocs_;
+        Clock::time_point begin_;
+    };
+};
+
+} // namespace fuzz
@@ -0,0 +1,45 @@
+#include <cstdlib>
+
+#include <sstream>
+#include <string>
+
+#include <fe/loc.cpp.h>
+
+#include "budget.h"
+#include "let.h"
+
+namespace {
+
+// Each byte may yield a token and a diagnostic; but the work per byte must stay constant.
+// The base budget accounts for the Driver's first Arena page and the keywords.
+// clang-format off
+constexpr fuzz::Budget Budget = {
+    .ns_base     = 5e7, .ns_per_byte     = 5e3,
+    .allocs_base = 64,  .allocs_per_byte = 16,
+    .bytes_base  = 2 * fe::Arena::Default_Page_Size, .bytes_per_byte = 512,
+};
+// clang-format on
+
+/// Discards all Diag%nostics - we are only interested in how many there are.
+class NullSink : public fe::DiagSink {
+public:
+    void diag(const fe::Diag&) override {}
+};
+
+} // namespace
+
+/// Lexes the whole input with the Let Lexer and checks that each token - but the final EoF - consumes at least one
+/// byte.
+/// Invalid UTF-8 and invalid characters must be reported as errors, but must not stop the Lexer.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::istringstream is(std::string((const char*)data, size));
+
+    fuzz::Budget::Scope scope(Budget, size);
+    fe::Driver driver;
+    driver.diags().sink(std::make_unique<NullSink>());
+    Lexer lexer(driver, is);
+
+    for (size_t num = 0; lexer.lex().tag() != Tok::Tag::EoF; ++num)
+        if (num > size) std::abort(); // no progress
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+/// @file
+/// Stand-alone driver for compilers without libFuzzer:
+/// Runs `LLVMFuzzerTestOneInput` once on each file given - or contained in a directory given - on the command line.
+/// Arguments starting with `-` are ignored; this allows for the same command line as with libFuzzer:
+/// ```
+/// fe-fuzz-lexer -runs=0 fuzz/corpus/lexer
+/// ```
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    std::vector<fs::path> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with('-')) continue;
+        if (fs::is_directory(arg)) {
+            for (const auto& entry : fs::recursive_directory_iterator(arg))
+                if (entry.is_regular_file()) files.emplace_back(entry.path());
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    std::ranges::sort(files);
+
+    for (const auto& file : files) {
+        std::ifstream ifs(file, std::ios::binary);
+        if (!ifs) {
+            std::cerr << "error: cannot read '" << file.string() << "'\n";
+            return EXIT_FAILURE;
+        }
+        std::vector<uint8_t> data(std::istreambuf_iterator<char>(ifs), {});
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    std::cout << "executed " << files.size() << " inputs\n";
+}
@@ -0,0 +1,65 @@
+#include <cstdlib>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fe/sym.h>
+
+#include "budget.h"
+
+namespace {
+
+// Each distinct string lives once in the SymPool's Arena and once in its hash set.
+// Interning a string again must not leave anything behind: SymPool::sym rolls its Arena back and must not leak a node
+// of its hash set.
+// clang-format off
+constexpr fuzz::Budget Budget = {
+    .ns_base     = 5e7,  .ns_per_byte     = 5e3,
+    .allocs_base = 64,   .allocs_per_byte = 1,
+    .bytes_base  = 2 * fe::Arena::Default_Page_Size, .bytes_per_byte = 64,
+};
+// clang-format on
+
+void check(bool cond) {
+    if (!cond) std::abort();
+}
+
+} // namespace
+
+/// Splits the input at each `\n` and interns all parts - twice.
+/// Checks that
+/// * each Sym yields the very same string again,
+/// * equal strings yield the same Sym and different strings different Sym%s, and
+/// * interning a string the second time does not allocate.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view in((const char*)data, size);
+    std::vector<std::string_view> strs;
+    for (size_t i = 0, j; i <= in.size(); i = j + 1) {
+        j = std::min(in.find('\n', i), in.size());
+        strs.emplace_back(in.substr(i, j - i));
+    }
+
+    fe::SymPool pool;
+    std::vector<fe::Sym> syms;
+    syms.reserve(strs.size());
+    {
+        fuzz::Budget::Scope scope(Budget, size);
+        for (auto str : strs) syms.emplace_back(pool.sym(str));
+
+        auto allocs = fuzz::Allocs::get();
+        for (size_t i = 0, e = strs.size(); i != e; ++i) check(pool.sym(strs[i]) == syms[i]);
+        check(fuzz::Allocs::get().num == allocs.num);
+    }
+
+    std::vector<std::pair<std::string_view, fe::Sym>> pairs;
+    for (size_t i = 0, e = strs.size(); i != e; ++i) {
+        check(syms[i].view() == strs[i]);
+        pairs.emplace_back(strs[i], syms[i]);
+    }
+    std::ranges::sort(pairs, {}, [](const auto& p) { return p.first; });
+    for (size_t i = 1, e = pairs.size(); i < e; ++i)
+        check((pairs[i - 1].first == pairs[i].first) == (pairs[i - 1].second == pairs[i].second));
+    return 0;
+}
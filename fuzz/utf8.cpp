@@ -0,0 +1,57 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <sstream>
+#include <string>
+
+#include <fe/utf8.h>
+
+#include "budget.h"
+
+namespace utf8 = fe::utf8;
+
+namespace {
+
+// Decoding must neither allocate nor take more than a few ns per byte.
+// clang-format off
+constexpr fuzz::Budget Budget = {
+    .ns_base     = 1e7, .ns_per_byte     = 1e3,
+    .allocs_base = 0,   .allocs_per_byte = 0,
+    .bytes_base  = 0,   .bytes_per_byte  = 0,
+};
+// clang-format on
+
+void check(bool cond) {
+    if (!cond) std::abort();
+}
+
+} // namespace
+
+/// Decodes the whole input with utf8::decode and checks that
+/// * decoding always makes progress but never consumes more than utf8::Max bytes at once, and
+/// * whatever decodes to a code point is a well-formed sequence that encodes back to the very same bytes - unless it
+///   was an overlong sequence or is out of the Unicode range.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::istringstream is(std::string((const char*)data, size));
+    auto pos = [&is] { return size_t(is.rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in)); };
+
+    fuzz::Budget::Scope scope(Budget, size);
+    for (size_t begin = 0;;) {
+        auto c   = utf8::decode(is);
+        auto end = pos();
+        if (c == utf8::EoF && end == size) break;
+        check(begin < end && end - begin <= utf8::Max);
+
+        if (c != utf8::Null) {
+            auto n = end - begin;
+            check(n == utf8::num_bytes(data[begin]));
+
+            char buf[utf8::Max];
+            auto m = utf8::encode(buf, c);
+            check(m <= n);
+            check(m != n || std::memcmp(buf, data + begin, n) == 0);
+        }
+        begin = end;
+    }
+    return 0;
+}
@@ -1,13 +1,42 @@
 #pragma once
 
-#include <algorithm>
 #include <list>
 #include <memory>
+#include <utility>
+
+#ifdef FE_ARENA_PROFILE
+#    include <algorithm>
+#    include <iomanip>
+#    include <ostream>
+#    include <string_view>
+#    include <unordered_map>
+#    include <vector>
+#endif
 
 #include "fe/assert.h"
+#include "fe/trace.h"
 
 namespace fe {
 
+#ifdef FE_ARENA_PROFILE
+namespace detail {
+/// Human-readable name of @p T - without RTTI.
+template<class T> constexpr std::string_view type_name() {
+#    if defined(__clang__) || defined(__GNUC__)
+    std::string_view s = __PRETTY_FUNCTION__; // "... type_name() [T = Foo]" or "... [with T = Foo; ...]"
+    auto b             = s.find("T = ") + 4;
+    return s.substr(b, s.find_first_of(";]", b) - b);
+#    elif defined(_MSC_VER)
+    std::string_view s = __FUNCSIG__; // "... type_name<Foo>(void)"
+    auto b             = s.find("type_name<") + 10;
+    return s.substr(b, s.rfind(">(void)") - b);
+#    else
+    return "<unknown type>";
+#    endif
+}
+} // namespace detail
+#endif
+
 /// An arena pre-allocates so-called *pages* of size Arena::page_size_.
 /// You can use Arena::allocate to obtain memory from this.
 /// When a page runs out of memory, the next page will be (pre-)allocated.
@@ -66,6 +95,9 @@ public:
 
     template<class T> using Ptr = std::unique_ptr<T, Deleter<T>>;
     template<class T, class... Args> Ptr<T> mk(Args&&... args) {
+#ifdef FE_ARENA_PROFILE
+        profile_.record(detail::type_name<T>(), sizeof(T), 1);
+#endif
         auto ptr = new (allocate(sizeof(T))) T(std::forward<Args&&>(args)...);
         return Ptr<T>(ptr, Deleter<T>());
     }
@@ -94,9 +126,14 @@ public:
     /// Get @p n bytes of fresh memory.
     [[nodiscard]] void* allocate(size_t num_bytes) {
         if (index_ + num_bytes > pages_.back().size) {
-            pages_.emplace_back(std::max(page_size_, num_bytes));
+            pages_.emplace_back(num_bytes > page_size_ ? num_bytes : page_size_);
             index_ = 0;
+            FE_TRACE_COUNT(Arena_Pages, 1);
         }
+        FE_TRACE_COUNT(Arena_Bytes, num_bytes);
+#ifdef FE_ARENA_PROFILE
+        profile_.total += num_bytes;
+#endif
 
         auto result = pages_.back().buffer.get() + index_;
         index_ += num_bytes;
@@ -104,8 +141,11 @@ public:
     }
 
     template<class T> [[nodiscard]] T* allocate(size_t num_elems) {
+#ifdef FE_ARENA_PROFILE
+        profile_.record(detail::type_name<T>(), sizeof(T), num_elems);
+#endif
         align(alignof(T));
-        return static_cast<T*>(allocate(num_elems * std::max(sizeof(T), alignof(T))));
+        return static_cast<T*>(allocate(num_elems * sizeof(T))); // sizeof(T) is a multiple of alignof(T)
     }
     ///@}
 
@@ -113,7 +153,13 @@ public:
     /// Deallocate memory again in reverse order.
     ///@{
     /// Removes @p num_bytes again.
-    void deallocate(size_t num_bytes) { index_ -= num_bytes; }
+    void deallocate(size_t num_bytes) {
+        index_ -= num_bytes;
+#ifdef FE_ARENA_PROFILE
+        profile_.total -= num_bytes;
+        profile_.rolled_back += num_bytes;
+#endif
+    }
 
     /// Goes back to @p state in Arena.
     /// Use like this:
@@ -123,13 +169,40 @@ public:
     /// if (/* I don't want that */) arena.deallocate(state);
     /// ```
     /// @warning Only use, if you really know what you are doing.
+    /// `first` is the number of pages and `second` the index into the last one.
+#ifdef FE_ARENA_PROFILE
+    struct State : std::pair<size_t, size_t> {
+        size_t total; ///< Profile::total at this point.
+
+        bool operator==(const State&) const = default;
+    };
+
+    State state() const { return {{pages_.size(), index_}, profile_.total}; }
+#else
     using State = std::pair<size_t, size_t>;
+
     State state() const { return {pages_.size(), index_}; }
+#endif
     void deallocate(State state) {
         if (state.first == pages_.size())
             index_ = state.second; // don't care otherwise
         else
             index_ = 0;
+#ifdef FE_ARENA_PROFILE
+        profile_.rolled_back += profile_.total - state.total;
+        profile_.total = state.total;
+#endif
+    }
+    ///@}
+
+    /// @name Footprint
+    ///@{
+    size_t num_pages() const { return pages_.size(); }
+    /// Bytes of all pages - used or not.
+    size_t num_bytes() const {
+        size_t res = 0;
+        for (const auto& page : pages_) res += page.size;
+        return res;
     }
     ///@}
 
@@ -139,9 +212,73 @@ public:
         swap(a1.pages_,     a2.pages_);
         swap(a1.page_size_, a2.page_size_);
         swap(a1.index_,     a2.index_);
+#ifdef FE_ARENA_PROFILE
+        swap(a1.profile_,   a2.profile_);
+#endif
         // clang-format on
     }
 
+#ifdef FE_ARENA_PROFILE
+    /// @name Profile
+    /// Only available if `FE_ARENA_PROFILE` is defined (e.g., via the CMake option of the same name).
+    /// Records which types consume how much memory of this Arena - via Arena::mk, Arena::allocate<T>, and hence,
+    /// Arena::Allocator.
+    /// Untyped Arena::allocate%tions - e.g. from SymPool - show up as `<untagged>` in the report.
+    /// Bytes that Arena::deallocate gives back - e.g. a HashCons hit or a ScopeTable::pop - are subtracted from
+    /// Profile::total and reported as Profile::rolled_back; the Entry%s per type still count them:
+    /// ```
+    /// arena.profile().dump(std::cerr);
+    /// ```
+    ///@{
+    struct Profile {
+        struct Entry {
+            std::string_view type;
+            size_t size       = 0; ///< `sizeof` one element.
+            size_t num_allocs = 0;
+            size_t num_elems  = 0;
+            size_t num_bytes  = 0;
+        };
+
+        void record(std::string_view type, size_t size, size_t num_elems) {
+            auto& entry = entries[type];
+            entry.type  = type;
+            entry.size  = size;
+            entry.num_allocs += 1;
+            entry.num_elems += num_elems;
+            entry.num_bytes += size * num_elems;
+        }
+
+        /// All Entry%s sorted by Entry::num_bytes in descending order.
+        std::vector<Entry> report() const {
+            std::vector<Entry> res;
+            size_t tagged = 0;
+            for (const auto& [_, entry] : entries) res.emplace_back(entry), tagged += entry.num_bytes;
+            if (total + rolled_back > tagged) res.emplace_back("<untagged>", 1, 0, 0, total + rolled_back - tagged);
+            std::ranges::sort(res, [](const auto& e1, const auto& e2) {
+                return e1.num_bytes != e2.num_bytes ? e1.num_bytes > e2.num_bytes : e1.type < e2.type;
+            });
+            return res;
+        }
+
+        void dump(std::ostream& os) const {
+            os << std::setw(14) << "bytes" << std::setw(12) << "allocs" << std::setw(12) << "elems" << std::setw(8)
+               << "size" << "  type\n";
+            for (const auto& e : report())
+                os << std::setw(14) << e.num_bytes << std::setw(12) << e.num_allocs << std::setw(12) << e.num_elems
+                   << std::setw(8) << e.size << "  " << e.type << '\n';
+            if (rolled_back != 0) os << std::setw(14) << rolled_back << "  rolled back\n";
+            os << std::setw(14) << total << "  total\n";
+        }
+
+        std::unordered_map<std::string_view, Entry> entries;
+        size_t total       = 0; ///< Bytes requested via Arena::allocate - tagged or not - minus rolled_back.
+        size_t rolled_back = 0; ///< Bytes given back via Arena::deallocate.
+    };
+
+    const Profile& profile() const { return profile_; }
+    ///@}
+#endif
+
 private:
     struct Page {
         Page(size_t size)
@@ -154,6 +291,9 @@ private:
     std::list<Page> pages_;
     size_t page_size_;
     size_t index_ = 0;
+#ifdef FE_ARENA_PROFILE
+    Profile profile_;
+#endif
 };
 
 } // namespace fe
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+
+#include <algorithm>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+
+#include "fe/arena.h"
+#include "fe/cast.h"
+#include "fe/loc.h"
+
+namespace fe {
+
+template<class B> class AST;
+
+/// Base class for AST nodes of the hierarchy rooted in @p B that live in an AST's Arena.
+/// Inherit from this class using [CRTP](https://en.wikipedia.org/wiki/Curiously_recurring_template_pattern):
+/// ```
+/// class Expr; class BinExpr; class AddExpr; class LitExpr;
+/// class Expr : public fe::ASTNode<Expr> {
+/// public:
+///     using Kinds = fe::Kinds<Expr, fe::Kinds<BinExpr, AddExpr>, LitExpr>;
+/// };
+/// class BinExpr : public Expr {
+/// public:
+///     Expr* lhs() const { return op(0); }
+///     Expr* rhs() const { return op(1); }
+/// };
+/// class LitExpr : public Expr {
+/// public:
+///     LitExpr(uint64_t val) : val(val) {}
+///     uint64_t val;
+/// };
+///
+/// fe::AST<Expr> ast;
+/// auto lit = ast.mk<LitExpr>(loc, {}, 23);
+/// auto add = ast.mk<AddExpr>(loc, {lit, ast.mk<LitExpr>(loc, {}, 42)});
+/// if (auto bin = add->isa<BinExpr>()) /*...*/; // see RuntimeCast and fe::visit
+/// ```
+/// An ASTNode is four words on 64-bit:
+/// its fe::Kinds kind, its source Pos%itions (but *not* the path, see ASTNode::loc), its parent, and its
+/// *operands* - the child nodes - which AST::mk places right behind the node in the Arena.
+/// @warning The AST never runs destructors: All node classes must be trivially destructible;
+/// e.g., use Sym instead of `std::string` and `std::span`s of Arena memory instead of `std::vector`.
+template<class B> class ASTNode : public RuntimeCast<B> {
+public:
+    /// @name Getters
+    ///@{
+    size_t kind() const { return kind_; } ///< Set by AST::mk *after* construction.
+    /// Pass the path of the file this AST stems from, if needed.
+    Loc loc(const std::filesystem::path* path = nullptr) const { return {path, begin_, finis_}; }
+    B* parent() const { return parent_; } ///< `nullptr` for the root.
+    ///@}
+
+    /// @name Operands
+    ///@{
+    std::span<B* const> ops() const { return {ops_, num_ops_}; }
+    size_t num_ops() const { return num_ops_; }
+    B* op(size_t i) const {
+        assert(i < num_ops_);
+        return ops_[i];
+    }
+    ///@}
+
+private:
+    B* parent_ = nullptr;
+    B** ops_   = nullptr;
+    Pos begin_, finis_;
+    uint32_t kind_    = 0;
+    uint32_t num_ops_ = 0;
+
+    friend class AST<B>;
+};
+
+/// Owns all ASTNode%s of the hierarchy rooted in @p B.
+/// Creating nodes is a matter of bumping a pointer in an Arena - no heap calls apart from new Arena pages.
+template<class B> class AST {
+public:
+    AST(size_t page_size = Arena::Default_Page_Size)
+        : arena_(page_size) {}
+
+    /// Creates `T(args...)` in the Arena followed by a copy of @p ops,
+    /// and makes the new node the ASTNode::parent of all its (non-`nullptr`) @p ops.
+    template<class T, class... Args> T* mk(Loc loc, std::span<B* const> ops, Args&&... args) {
+        static_assert(std::is_base_of_v<ASTNode<B>, T>);
+        static_assert(std::is_trivially_destructible_v<T>, "AST never runs destructors");
+
+        auto node        = new (arena_.allocate<T>(1)) T(std::forward<Args>(args)...);
+        ASTNode<B>* base = node;
+        if (!ops.empty()) {
+            base->ops_ = arena_.allocate<B*>(ops.size());
+            std::ranges::copy(ops, base->ops_);
+            for (ASTNode<B>* op : ops) {
+                if (op) {
+                    assert(op->parent_ == nullptr && "an ASTNode may only have one parent");
+                    op->parent_ = node;
+                }
+            }
+        }
+        base->begin_   = loc.begin;
+        base->finis_   = loc.finis;
+        base->kind_    = uint32_t(B::Kinds::template kind<T>);
+        base->num_ops_ = uint32_t(ops.size());
+        return node;
+    }
+    template<class T, class... Args> T* mk(Loc loc, std::initializer_list<B*> ops, Args&&... args) {
+        return mk<T>(loc, std::span<B* const>(ops.begin(), ops.size()), std::forward<Args>(args)...);
+    }
+
+    /// Use this for trivially destructible payloads - e.g., an array of Sym%s - in the same Arena.
+    Arena& arena() { return arena_; }
+    size_t num_bytes() const { return arena_.num_bytes(); }
+
+private:
+    Arena arena_;
+};
+
+} // namespace fe
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+
+#include <type_traits>
+
 #include "fe/assert.h"
 
 namespace fe {
@@ -10,8 +14,93 @@ concept Nodeable = requires(T n) {
     n.node();
 };
 
+template<class Root, class... Children> struct Kinds;
+
+/// @name Kinds
+/// [LLVM-style](https://llvm.org/docs/HowToSetUpLLVMStyleRTTI.html) range-based RTTI.
+/// Declare your class hierarchy as a tree of Kinds - forward declarations suffice:
+/// ```
+/// class Expr; class BinExpr; class AddExpr; class MulExpr; class LitExpr;
+/// using ExprKinds = fe::Kinds<Expr, fe::Kinds<BinExpr, AddExpr, MulExpr>, LitExpr>;
+/// ```
+/// Kinds numbers the classes in pre-order - `Expr` = 0, `BinExpr` = 1, `AddExpr` = 2, `MulExpr` = 3, `LitExpr` = 4 -
+/// so each subtree occupies a contiguous range of kinds:
+/// `isa<BinExpr>()` boils down to `1 <= kind() && kind() <= 3` - without any `dynamic_cast`.
+/// See RuntimeCast for how to hook this up.
+///@{
+struct KindRange {
+    static constexpr size_t Invalid = size_t(-1);
+
+    size_t first = Invalid;
+    size_t last  = Invalid; ///< Inclusive.
+
+    constexpr bool contains(size_t kind) const { return kind - first <= last - first; } // one unsigned comparison
+    constexpr explicit operator bool() const { return first != Invalid; }
+};
+
+namespace detail {
+template<class T> struct KindTree {
+    using type = Kinds<T>; // leaf
+};
+template<class Root, class... Children> struct KindTree<Kinds<Root, Children...>> {
+    using type = Kinds<Root, Children...>;
+};
+template<class T> using kind_tree_t = typename KindTree<T>::type;
+} // namespace detail
+
+template<class Root, class... Children> struct Kinds {
+    /// Number of classes in this (sub)tree.
+    static constexpr size_t size = (1 + ... + detail::kind_tree_t<Children>::size);
+
+    /// Pre-order range of @p T and all its subclasses or an invalid KindRange, if @p T is not part of this tree.
+    template<class T> static constexpr KindRange range(size_t first = 0) {
+        if constexpr (std::is_same_v<T, Root>) {
+            return {first, first + size - 1};
+        } else {
+            KindRange res;
+            size_t next = first + 1;
+            ((res ? void() : (res = detail::kind_tree_t<Children>::template range<T>(next), void()),
+              next += detail::kind_tree_t<Children>::size),
+             ...);
+            return res;
+        }
+    }
+
+    /// Kind of @p T; pass this to the constructor of your base class.
+    template<class T> static constexpr size_t kind = [] {
+        constexpr auto r = range<T>();
+        static_assert(r, "class is not part of this hierarchy");
+        return r.first;
+    }();
+};
+///@}
+
+template<class B>
+concept Kindable = requires(const B& b) {
+    typename B::Kinds;
+    b.kind();
+};
+
 /// Inherit from this class using [CRTP](https://en.wikipedia.org/wiki/Curiously_recurring_template_pattern),
 /// for some nice `dynamic_cast`-style wrappers.
+/// In order of preference, RuntimeCast::isa uses
+/// 1. the ranges of fe::Kinds, if @p B isa fe::Kindable:
+///     ```
+///     class Expr : public fe::RuntimeCast<Expr> {
+///     public:
+///         using Kinds = ExprKinds; // see fe::Kinds
+///         Expr(size_t kind) : kind_(kind) {}
+///         size_t kind() const { return kind_; }
+///     private:
+///         size_t kind_;
+///     };
+///     class AddExpr : public BinExpr {
+///     public:
+///         AddExpr() : BinExpr(Kinds::kind<AddExpr>) {}
+///     };
+///     ```
+/// 2. an exact match via `node() == T::Node`, if @p T isa fe::Nodeable,
+/// 3. `dynamic_cast` otherwise.
 template<class B> class RuntimeCast {
 public:
     // clang-format off
@@ -19,10 +108,13 @@ public:
     template<class T> T* as() { assert(isa<T>()); return static_cast<T*>(this); }
 
     /// `dynamic_cast`.
-    /// If @p T isa fe::Nodeable, it will use `node()`, otherwise a `dynamic_cast`.
     template<class T>
     T* isa() {
-        if constexpr (Nodeable<T>) {
+        if constexpr (Kindable<B>) {
+            constexpr auto range = B::Kinds::template range<T>();
+            static_assert(range, "class is not part of B::Kinds");
+            return range.contains(size_t(static_cast<B*>(this)->kind())) ? static_cast<T*>(this) : nullptr;
+        } else if constexpr (Nodeable<T>) {
             return static_cast<B*>(this)->node() == T::Node ? static_cast<T*>(this) : nullptr;
         } else {
             return dynamic_cast<T*>(static_cast<B*>(this));
@@ -38,4 +130,150 @@ public:
     // clang-format on
 };
 
+/// @name visit
+/// Dispatches on the dynamic type of a node - instead of a chain of RuntimeCast::isa:
+/// ```
+/// auto prec = fe::visit(expr,                                // expr is an Expr& or a const Expr&
+///                       [](const AddExpr&) { return 1; },
+///                       [](const BinExpr&) { return 2; },    // MulExpr ends up here
+///                       [](const Expr&) { return 0; });      // fallback for all remaining classes
+/// ```
+/// Each table entry invokes the overload that C++ overload resolution picks for the respective class.
+/// Thus, each class needs a viable overload - add a fallback for the base class as shown above.
+/// The result type is the `std::common_type` of all invoked overloads.
+/// @note fe::visit expands the classes into the `case`s of a `switch` which compilers lower to a jump table - i.e.,
+/// one indirect jump, no matter how many node classes there are, with the overloads inlined.
+/// Hierarchies with more than 64 classes use a `constexpr` table of function pointers instead.
+///@{
+
+/// The usual overload pattern.
+template<class... Fs> struct overloaded : Fs... {
+    using Fs::operator()...;
+};
+template<class... Fs> overloaded(Fs...) -> overloaded<Fs...>;
+
+namespace detail {
+template<class... Ts> struct TypeList {};
+
+template<class... Ls> struct Concat;
+template<class... Ts> struct Concat<TypeList<Ts...>> {
+    using type = TypeList<Ts...>;
+};
+template<class... Ts, class... Us, class... Ls> struct Concat<TypeList<Ts...>, TypeList<Us...>, Ls...> {
+    using type = typename Concat<TypeList<Ts..., Us...>, Ls...>::type;
+};
+
+/// All classes of a Kinds tree in pre-order - i.e., ordered by kind.
+template<class K> struct Flatten;
+template<class Root, class... Children> struct Flatten<Kinds<Root, Children...>> {
+    using type = typename Concat<TypeList<Root>, typename Flatten<kind_tree_t<Children>>::type...>::type;
+};
+
+template<class N, class T> using copy_const_t = std::conditional_t<std::is_const_v<N>, const T, T>;
+
+template<class N, class F, class... Ts>
+using visit_result_t = std::common_type_t<std::invoke_result_t<F&, copy_const_t<N, Ts>&>...>;
+
+template<size_t I, class T, class... Ts> struct At : At<I - 1, Ts...> {};
+template<class T, class... Ts> struct At<0, T, Ts...> {
+    using type = T;
+};
+template<size_t I, class... Ts> using at_t = typename At<I, Ts...>::type;
+
+template<class R, class T, class N, class F> R invoke_as(N& n, F& f) {
+    return f(static_cast<copy_const_t<N, T>&>(n));
+}
+
+/// Hierarchies up to this size get a `switch`, larger ones a table of function pointers.
+inline constexpr size_t Max_Switch_Size = 64;
+
+/// Invokes @p f with @p n cast to the @p i-th class of @p Ts - one indirect jump, no matter how many @p Ts there are:
+/// * Up to Max_Switch_Size classes are dispatched via a `switch` with one `case` per class.
+///   Compilers lower this to a jump table and inline the overloads.
+/// * Beyond that, dispatch is one indirect call through a `constexpr` table with one thunk per class.
+///
+/// An out-of-range @p i asserts in debug builds and is undefined behavior in release builds.
+template<class R, class N, class F, class... Ts> R dispatch_index(size_t i, N& n, F& f, TypeList<Ts...>) {
+    if constexpr (sizeof...(Ts) <= Max_Switch_Size) {
+        switch (i) {
+#define FE_VISIT_CASE(I)                                                                \
+    case (I):                                                                           \
+        if constexpr ((I) < sizeof...(Ts)) return invoke_as<R, at_t<(I), Ts...>>(n, f); \
+        else fe::unreachable();
+#define FE_VISIT_CASE4(I)  FE_VISIT_CASE(I) FE_VISIT_CASE(I + 1) FE_VISIT_CASE(I + 2) FE_VISIT_CASE(I + 3)
+#define FE_VISIT_CASE16(I) FE_VISIT_CASE4(I) FE_VISIT_CASE4(I + 4) FE_VISIT_CASE4(I + 8) FE_VISIT_CASE4(I + 12)
+            FE_VISIT_CASE16(0)
+            FE_VISIT_CASE16(16)
+            FE_VISIT_CASE16(32)
+            FE_VISIT_CASE16(48)
+#undef FE_VISIT_CASE16
+#undef FE_VISIT_CASE4
+#undef FE_VISIT_CASE
+            default: fe::unreachable();
+        }
+    } else {
+        static constexpr R (*table[])(N&, F&) = {&invoke_as<R, Ts, N, F>...};
+        assert(i < sizeof...(Ts));
+        return table[i](n, f);
+    }
+}
+
+/// Maps `T::Node` of each of the @p Ts to its index in `TypeList<N, Ts...>` via a `constexpr` lookup table - and any
+/// other `node()` to 0.
+/// The table spans from the smallest to the largest `T::Node`, so these should be reasonably dense - like an `enum`.
+template<class... Ts> struct NodeIndex {
+    static constexpr size_t lo = [] {
+        size_t res = size_t(-1);
+        ((res = size_t(Ts::Node) < res ? size_t(Ts::Node) : res), ...);
+        return res;
+    }();
+    static constexpr size_t hi = [] {
+        size_t res = 0;
+        ((res = size_t(Ts::Node) > res ? size_t(Ts::Node) : res), ...);
+        return res;
+    }();
+    static constexpr size_t size = hi - lo + 1;
+    static_assert(size <= 4096, "T::Node values are too sparse for a lookup table");
+    static_assert(sizeof...(Ts) < 65535);
+
+    struct Table {
+        unsigned short index[size];
+    };
+    static constexpr Table table = [] {
+        Table res{};
+        unsigned short i = 1;
+        ((res.index[size_t(Ts::Node) - lo] = res.index[size_t(Ts::Node) - lo] ? res.index[size_t(Ts::Node) - lo] : i,
+          ++i),
+         ...); // first match wins
+        return res;
+    }();
+
+    static constexpr size_t get(size_t node) { return node - lo < size ? table.index[node - lo] : 0; }
+};
+} // namespace detail
+
+/// Uses the pre-order kinds of `N::Kinds` - see fe::Kinds and fe::Kindable.
+template<class N, class... Fs>
+requires Kindable<std::remove_const_t<N>>
+decltype(auto) visit(N& node, Fs&&... fs) {
+    using F    = overloaded<std::remove_cvref_t<Fs>...>;
+    using List = typename detail::Flatten<typename std::remove_const_t<N>::Kinds>::type;
+    using R    = decltype([]<class... Ts>(detail::TypeList<Ts...>) -> detail::visit_result_t<N, F, Ts...> {}(List()));
+    F f{static_cast<Fs&&>(fs)...}; // std::forward needs <utility>
+    return detail::dispatch_index<R>(size_t(node.kind()), node, f, List());
+}
+
+/// Uses `node()` and `T::Node` of the fe::Nodeable classes @p Ts;
+/// all other `node()`s dispatch to the overload for @p N itself.
+template<class... Ts, class N, class... Fs>
+requires(sizeof...(Ts) != 0 && (Nodeable<Ts> && ...))
+decltype(auto) visit(N& node, Fs&&... fs) {
+    using F = overloaded<std::remove_cvref_t<Fs>...>;
+    using R = detail::visit_result_t<N, F, N, Ts...>;
+    F f{static_cast<Fs&&>(fs)...};
+    return detail::dispatch_index<R>(detail::NodeIndex<Ts...>::get(size_t(node.node())), node, f,
+                                     detail::TypeList<N, Ts...>());
+}
+///@}
+
 } // namespace fe
@@ -0,0 +1,785 @@
+#pragma once
+
+#include <cstdio>
+
+#include <atomic>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "fe/arena.h"
+#include "fe/format.h"
+#include "fe/loc.h"
+#include "fe/source.h"
+#include "fe/trace.h"
+
+namespace fe {
+
+/// A structured Diag%nostic as handed out by Diags::flush.
+struct Diag {
+    enum class Sev {
+        Note, ///< Additional information; attached to the preceding Sev::Warn or Sev::Err, if any.
+        Warn, ///< Warning.
+        Err,  ///< Error.
+    };
+
+    static constexpr std::string_view sev2str(Sev sev) {
+        switch (sev) {
+            case Sev::Note: return "note";
+            case Sev::Warn: return "warning";
+            case Sev::Err: return "error";
+            default: fe::unreachable();
+        }
+    }
+
+    Sev sev;
+    Loc loc;
+    std::string_view code;       ///< Optional identifier like `"W0815"`; used for filtering.
+    std::string_view msg;        ///< Points into the buffer of Diags and is only valid until Diags::flush returns.
+    std::span<const Diag> notes; ///< Sev::Note%s attached to this Diag%nostic.
+};
+
+namespace detail {
+/// Where a DiagSink writes to: any `std::basic_ostream<char>`, a `std::FILE*`, or - by default - `std::cerr`.
+/// A `std::FILE*` like `stderr` bypasses iostreams - and hence, doesn't see a `std::cerr` redirected via `rdbuf`.
+class Output {
+public:
+    Output()
+        : Output(std::cerr) {}
+    Output(std::FILE* file)
+        : dst_(file)
+        , write_([](void* dst, std::string_view s) {
+            std::fwrite(s.data(), 1, s.size(), static_cast<std::FILE*>(dst));
+        })
+        , flush_([](void* dst) { std::fflush(static_cast<std::FILE*>(dst)); }) {}
+    template<class Traits>
+    Output(std::basic_ostream<char, Traits>& os)
+        : dst_(&os)
+        , write_([](void* dst, std::string_view s) {
+            static_cast<std::basic_ostream<char, Traits>*>(dst)->write(s.data(), s.size());
+        })
+        , flush_([](void* dst) { static_cast<std::basic_ostream<char, Traits>*>(dst)->flush(); }) {}
+
+    void write(std::string_view s) const { write_(dst_, s); } ///< Leaves flushing to the buffering of the stream.
+    void flush() const { flush_(dst_); }
+
+private:
+    void* dst_;
+    void (*write_)(void*, std::string_view);
+    void (*flush_)(void*);
+};
+
+/// Bottom-up merge sort; `std::ranges::stable_sort` would add about 10k preprocessed lines of `<algorithm>` to
+/// fe/driver.h.
+template<class T, class Less> void stable_sort(std::vector<T>& v, Less less) {
+    std::vector<T> tmp(v.size());
+    for (size_t width = 1, n = v.size(); width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi  = mid + width < n ? mid + width : n;
+            size_t i = lo, j = mid, k = lo;
+            while (i != mid && j != hi) tmp[k++] = less(v[j], v[i]) ? v[j++] : v[i++]; // left wins ties
+            while (i != mid) tmp[k++] = v[i++];
+            while (j != hi) tmp[k++] = v[j++];
+        }
+        v.swap(tmp);
+    }
+}
+} // namespace detail
+
+/// @name Sinks
+/// Diags hands out each batch of Diag%nostics to a DiagSink.
+///@{
+
+/// Consumer interface for Diag%nostics.
+/// Diags::flush invokes DiagSink::diag for each Diag%nostic of a batch (with its notes attached) and then
+/// DiagSink::flush.
+class DiagSink {
+public:
+    virtual ~DiagSink() = default;
+
+    virtual void diag(const Diag&) = 0; ///< Diag::msg and Diag::notes are only valid during this call.
+    virtual void flush() {}             ///< Invoked after the last Diag%nostic of a batch.
+    /// Flushes the underlying stream; invoked after an explicit Diags::flush and - with Diags::immediate - after each
+    /// Diag%nostic.
+    virtual void sync() {}
+    /// Invoked by Diags::summary after a final Diags::flush.
+    virtual void summary(size_t /*num_errors*/, size_t /*num_warnings*/, size_t /*num_suppressed*/) {}
+};
+
+/// Human-readable output like `file:1:2-1:5: error: message`.
+/// If you pass a SourceCache, the offending source line is shown below and the Loc%ation is underlined:
+/// ```
+/// file:2:7-2:9: error: message
+///     2 | let x = foo;
+///       |         ^~~
+/// ```
+/// SourceCache is thread-safe; so others may still add to it while a TextSink reads from it.
+class TextSink : public DiagSink {
+public:
+    TextSink(detail::Output out, SourceCache* sources = nullptr)
+        : dst_(out)
+        , sources_(sources) {}
+
+    void diag(const Diag& diag) override {
+        render(diag);
+        for (const auto& note : diag.notes) render(note);
+    }
+
+    void flush() override {
+        dst_.write(out_);
+        out_.clear();
+    }
+
+    void sync() override { dst_.flush(); }
+
+    /// Like `2 errors, 1 warning (5 suppressed)`.
+    void summary(size_t num_errors, size_t num_warnings, size_t num_suppressed) override {
+        format::format_to(std::back_inserter(out_), "{} error{}, {} warning{}", num_errors, num_errors == 1 ? "" : "s",
+                          num_warnings, num_warnings == 1 ? "" : "s");
+        if (num_suppressed != 0) format::format_to(std::back_inserter(out_), " ({} suppressed)", num_suppressed);
+        out_ += '\n';
+        flush();
+    }
+
+private:
+    void render(const Diag& diag) {
+        format::format_to(std::back_inserter(out_), "{}: {}: {}\n", diag.loc, Diag::sev2str(diag.sev), diag.msg);
+        if (sources_ != nullptr && diag.loc) snippet(diag.loc);
+    }
+
+    void snippet(Loc loc) {
+        auto source = sources_->get(loc.path);
+        if (source == nullptr) return;
+        auto line = source->line(loc.begin.row);
+        if (line.empty()) return;
+
+        auto width = format::formatted_size("{}", loc.begin.row);
+        format::format_to(std::back_inserter(out_), "{:>{}} | {}\n{:>{}} | ", loc.begin.row, width + 4, line, "",
+                          width + 4);
+
+        // Pos::col counts code points starting at 1; keep tabs so the underline matches the line above.
+        size_t col = 1, finis = loc.finis.row == loc.begin.row ? loc.finis.col : size_t(-1);
+        for (size_t i = 0, e = line.size(); i < e && col <= finis; ++col) {
+            auto c = line[i];
+            auto n = utf8::num_bytes(c);
+            i += n != 0 ? n : 1;
+            if (col < loc.begin.col)
+                out_ += c == '\t' ? '\t' : ' ';
+            else
+                out_ += col == loc.begin.col ? '^' : '~';
+        }
+        out_ += '\n';
+    }
+
+    detail::Output dst_;
+    SourceCache* sources_;
+    std::string out_;
+};
+
+///@}
+
+/// Collects Diag%nostics and emits them to a DiagSink - right away by default or in batches with Diags::batch.
+/// All messages are formatted into one reusable buffer and Diags::flush hands the whole batch to the DiagSink,
+/// which in turn writes it with a single `std::ostream::write` or `std::fwrite` instead of issuing one `std::endl` per
+/// message.
+/// Filters (Diags::min_sev, Diags::suppress, Diags::max_errors) and limits (Diags::dedup, Diags::max_per_loc, ...) are
+/// checked *before* anything is formatted.
+/// Use like this:
+/// ```
+/// fe::Diags diags;
+/// diags.sort(true).batch(1024).suppress("W0815");
+/// diags.emit(fe::Diag::Sev::Err, loc, "unknown identifier '{}'", sym);
+/// diags.emit(fe::Diag::Sev::Note, prev, "did you mean '{}'?", other);
+/// diags.flush(); // otherwise, happens automatically upon destruction or when the 1025th warning/error arrives
+/// ```
+/// By default, Diags is Diags::immediate: Each Diag%nostic is written and flushed as soon as it is emitted - just like
+/// `std::endl` would do.
+/// Batching is opt-in, as pending Diag%nostics are lost if the program crashes, `std::abort`s, or `std::exit`s
+/// without destroying the Diags; and they appear *after* anything else written to the same stream in the meantime.
+/// Diags::emit and Diags::flush are thread-safe.
+/// Worker threads should use a Diags::Local buffer to avoid contention.
+/// Set up the configuration before spawning any threads, though.
+class Diags {
+public:
+    class Local;
+    friend class DeferredDiags;
+
+    /// @name Construction/Destruction
+    ///@{
+    /// Uses a TextSink that writes to @p out - `std::cerr` by default; pass `stderr` to bypass iostreams.
+    Diags(detail::Output out = {})
+        : sink_(std::make_unique<TextSink>(out)) {}
+    /// Takes over sink, configuration, counters, and pending Diag%nostics of @p other, which may only be destroyed
+    /// afterwards.
+    /// @warning Neither Diags may be in use by another thread or a Diags::Local.
+    Diags(Diags&& other) noexcept
+        : sink_(std::move(other.sink_))
+        , sort_(other.sort_)
+        , batch_size_(other.batch_size_)
+        , immediate_(other.immediate_)
+        , min_sev_(other.min_sev_)
+        , suppressed_(std::move(other.suppressed_))
+        , max_errors_(other.max_errors_)
+        , num_errors_(other.num_errors_.load())
+        , num_warnings_(other.num_warnings_.load())
+        , num_dropped_(other.num_dropped_.load())
+        , limited_(other.limited_)
+        , limits_(std::move(other.limits_))
+        , batch_(std::move(other.batch_)) {
+        other.batch_.clear();
+    }
+    Diags(const Diags&)            = delete;
+    Diags& operator=(const Diags&) = delete;
+    ~Diags() { flush(); }
+    ///@}
+
+    /// @name Configuration
+    ///@{
+    Diags& sink(std::unique_ptr<DiagSink>&& sink) { return flush(), sink_ = std::move(sink), *this; }
+    /// Use a TextSink.
+    Diags& sink(detail::Output out) { return sink(std::make_unique<TextSink>(out)); }
+    /// Sort each batch via Diags::less upon Diags::flush?
+    /// As this is a total order, the output does not depend on the order in which Diag%nostics were emitted.
+    /// Only useful together with Diags::batch.
+    Diags& sort(bool sort) { return sort_ = sort, *this; }
+    /// Switches from Diags::immediate to batching:
+    /// Automatically Diags::flush as soon as @p n warnings/errors are pending and the next one arrives - or a
+    /// Diags::Local merges; `0` means only on explicit flush.
+    /// Until then, notes may still attach to the last pending warning/error; so notes always travel with their parent.
+    /// Diags::flush or the destruction of Diags hands out the rest.
+    /// A note that comes after an explicit Diags::flush of its warning/error is handed out on its own.
+    Diags& batch(size_t n) { return batch_size_ = n, immediate_ = false, *this; }
+    /// Hand out each Diag%nostic - notes included - right away and flush the stream after it (see DiagSink::sync)?
+    /// This is the default; it costs one write and one flush per Diag%nostic.
+    /// Notes don't wait for their parent; so a DiagSink like JsonSink or SarifSink sees them on their own - use
+    /// Diags::batch to nest them.
+    /// A Diags::Local still buffers until it merges - and then, its Diag%nostics are written right away.
+    Diags& immediate(bool immediate) { return immediate_ = immediate, *this; }
+    ///@}
+
+    /// @name Filters
+    /// Diag%nostics that don't pass are dropped - including their notes - without being formatted.
+    ///@{
+    Diags& min_sev(Diag::Sev sev) { return min_sev_ = sev, *this; } ///< Drop everything below @p sev.
+    /// Drop all Diag%nostics with this @p code; @p code must outlive this Diags (e.g. a string literal).
+    Diags& suppress(std::string_view code) { return suppressed_.emplace_back(code), *this; }
+    Diags& max_errors(size_t n) { return max_errors_ = n, *this; } ///< Drop all errors after the first @p n.
+    ///@}
+
+    /// @name Limits
+    /// Rate limiting and deduplication of warnings/errors.
+    /// The *message id* of a Diag%nostic is its code or - if it has none - its format string.
+    /// Once you enable one of these, Diags needs to keep track of what has been emitted, which requires a lock.
+    ///@{
+    /// Drop a Diag%nostic if one with the same message id has already been emitted at the same Loc%ation.
+    Diags& dedup(bool dedup) { return limits_.dedup = dedup, update_limits(); }
+    Diags& max_per_loc(size_t n) { return limits_.per_loc = n, update_limits(); }   ///< Per Loc%ation.
+    Diags& max_per_file(size_t n) { return limits_.per_file = n, update_limits(); } ///< Per Loc::path.
+    Diags& max_total(size_t n) { return limits_.total = n, update_limits(); }       ///< Altogether.
+    ///@}
+
+    /// @name Getters
+    ///@{
+    DiagSink& sink() const { return *sink_; }
+    bool sort() const { return sort_; }
+    size_t batch() const { return batch_size_; }
+    bool immediate() const { return immediate_; }
+    /// Number of Diag%nostics not yet flushed; does not include those still residing in a Diags::Local buffer.
+    size_t num_pending() const {
+        std::lock_guard lock(mutex_);
+        return batch_.entries.size();
+    }
+    /// Number of warnings/errors that did not pass a filter or limit.
+    size_t num_dropped() const { return num_dropped_; }
+    size_t num_errors() const { return num_errors_; }     ///< Number of recorded errors.
+    size_t num_warnings() const { return num_warnings_; } ///< Number of recorded warnings.
+    ///@}
+
+    /// Formats the message into the internal buffer and records a Diag%nostic - if it passes all filters.
+    /// A Sev::Note is attached to the last Sev::Warn/Sev::Err of the current batch, if the same thread emitted it and
+    /// nothing else came in between; otherwise, the note is handed out on its own.
+    /// If the calling thread owns a Diags::Local of this Diags, the Diag%nostic goes there without locking.
+    /// Only the message is copied; @p code - and Loc::path of @p loc - must outlive this Diags (e.g. a string literal)
+    /// as pending Diag%nostics and Diags::dedup refer to them.
+    /// @returns whether the Diag%nostic was recorded.
+    template<class... Args>
+    bool emit(Diag::Sev sev, std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+        return emit_(sev, code, loc, fmt2str(fmt), fmt, std::forward<Args&&>(args)...);
+    }
+
+    template<class... Args> bool emit(Diag::Sev sev, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+        return emit(sev, {}, loc, fmt, std::forward<Args&&>(args)...);
+    }
+
+    /// Hands all pending Diag%nostics to the DiagSink and flushes its stream.
+    void flush() {
+        FE_TRACE_SCOPE("Diags::flush");
+        std::lock_guard lock(mutex_);
+        flush_();
+        if (sink_) sink_->sync(); // a moved-from Diags has none
+    }
+
+    /// Diags::flush%es and lets the DiagSink print a summary including the number of suppressed Diag%nostics.
+    void summary() {
+        std::lock_guard lock(mutex_);
+        flush_();
+        sink_->summary(num_errors_, num_warnings_, num_dropped_);
+        sink_->sync();
+    }
+
+    /// @name Order
+    ///@{
+    /// Orders by file, then by Loc::begin, and then by Loc::finis; Loc%ations without a file come first.
+    static bool less(Loc l1, Loc l2) {
+        if (l1.path != l2.path) {
+            if (l1.path == nullptr || l2.path == nullptr) return l1.path == nullptr;
+            if (auto cmp = l1.path->compare(*l2.path); cmp != 0) return cmp < 0;
+        }
+        if (l1.begin != l2.begin) return l1.begin < l2.begin;
+        return l1.finis < l2.finis;
+    }
+
+    /// Total order: by Loc, then Diag::sev, Diag::code, Diag::msg, and finally Diag::notes.
+    static bool less(const Diag& d1, const Diag& d2) {
+        if (less(d1.loc, d2.loc)) return true;
+        if (less(d2.loc, d1.loc)) return false;
+        if (d1.sev != d2.sev) return d1.sev < d2.sev;
+        if (d1.code != d2.code) return d1.code < d2.code;
+        if (d1.msg != d2.msg) return d1.msg < d2.msg;
+        for (size_t i = 0, e = d1.notes.size() < d2.notes.size() ? d1.notes.size() : d2.notes.size(); i != e; ++i) {
+            if (less(d1.notes[i], d2.notes[i])) return true;
+            if (less(d2.notes[i], d1.notes[i])) return false;
+        }
+        return d1.notes.size() < d2.notes.size();
+    }
+    ///@}
+
+private:
+    /// Like Diags::emit but with an explicit message @p id for the limits.
+    template<class... Args>
+    bool emit_(Diag::Sev sev,
+               std::string_view code,
+               Loc loc,
+               std::string_view id,
+               format::format_string<Args...> fmt,
+               Args&&... args);
+
+    static constexpr size_t No_Head = size_t(-1);
+
+    /// Identifies the calling thread - without `#include <thread>` for `std::this_thread::get_id`.
+    static const void* this_thread() {
+        static thread_local char tag;
+        return &tag;
+    }
+
+    struct Entry {
+        Diag::Sev sev;
+        Loc loc;
+        std::string_view code;
+        size_t begin, end;    ///< Message within Batch::text.
+        size_t num_notes = 0; ///< Number of Diag::Sev::Note%s directly following this Entry.
+        bool head        = false;
+    };
+
+    struct Batch {
+        template<class... Args>
+        void add(Diag::Sev sev, std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+            auto begin = text.size();
+            format::format_to(std::back_inserter(text), fmt, std::forward<Args&&>(args)...);
+            auto& entry = entries.emplace_back(Entry{sev, loc, code, begin, text.size()});
+            auto thread = this_thread();
+
+            if (sev == Diag::Sev::Note && head != No_Head && head_thread == thread) {
+                ++entries[head].num_notes;
+            } else {
+                // A note of another thread would end up between head and its notes, so it goes on its own.
+                entry.head = true;
+                ++num_heads;
+                head        = sev != Diag::Sev::Note ? entries.size() - 1 : No_Head;
+                head_thread = thread;
+            }
+        }
+
+        /// Moves all entries of @p other to the end of `this`.
+        void append(Batch& other) {
+            auto offset = text.size();
+            auto first  = entries.size();
+            text += other.text;
+            for (auto entry : other.entries) {
+                entry.begin += offset;
+                entry.end += offset;
+                entries.emplace_back(entry);
+            }
+            num_heads += other.num_heads;
+            head        = other.head != No_Head ? first + other.head : No_Head;
+            head_thread = other.head_thread;
+            other.clear();
+        }
+
+        void clear() {
+            entries.clear();
+            text.clear();
+            head      = No_Head;
+            num_heads = 0;
+        }
+
+        std::vector<Entry> entries;
+        std::string text; ///< All messages of this Batch.
+        size_t head      = No_Head;
+        size_t num_heads = 0;
+        bool drop_notes  = false; ///< Drop all notes until the next warning/error as their parent was dropped.
+
+        /// Notes from this thread go to Batch::head; `head == No_Head` if there is no Entry to attach notes to.
+        const void* head_thread = nullptr;
+    };
+
+    /// Checks filters and limits; the latter - and Diags::num_errors - also keep track of an admitted Diag%nostic.
+    bool admit(const Batch& batch, Diag::Sev sev, std::string_view code, Loc loc, std::string_view fmt) {
+        if (sev == Diag::Sev::Note) return !batch.drop_notes && min_sev_ == Diag::Sev::Note;
+        if (sev < min_sev_) return false;
+        if (!code.empty())
+            for (auto s : suppressed_)
+                if (s == code) return false;
+        if (limited_) return admit_limits(sev, code.empty() ? fmt : code, loc);
+        return sev != Diag::Sev::Err || count_error();
+    }
+
+    /// Increments Diags::num_errors unless Diags::max_errors is reached - check and increment are one atomic step, so
+    /// concurrent Diags::Local%s can't admit more than Diags::max_errors.
+    bool count_error() {
+        for (size_t n = num_errors_; n < max_errors_;)
+            if (num_errors_.compare_exchange_weak(n, n + 1)) return true;
+        return false;
+    }
+
+    bool admit_limits(Diag::Sev sev, std::string_view id, Loc loc) {
+        std::lock_guard lock(limits_mutex_);
+        auto loc_key = Limits::LocKey{loc.path, loc.begin, loc.finis};
+        if (sev == Diag::Sev::Err && num_errors_ >= max_errors_) return false;
+        if (limits_.num_total >= limits_.total) return false;
+        if (limits_.per_file != size_t(-1) && limits_.num_per_file[loc.path] >= limits_.per_file) return false;
+        if (limits_.per_loc != size_t(-1) && limits_.num_per_loc[loc_key] >= limits_.per_loc) return false;
+        if (limits_.dedup && !limits_.seen.emplace(loc_key, id).second) return false;
+        if (sev == Diag::Sev::Err && !count_error()) return false; // can't fail: we hold the lock
+
+        ++limits_.num_total;
+        if (limits_.per_file != size_t(-1)) ++limits_.num_per_file[loc.path];
+        if (limits_.per_loc != size_t(-1)) ++limits_.num_per_loc[loc_key];
+        return true;
+    }
+
+    Diags& update_limits() {
+        limited_ = limits_.dedup || limits_.per_loc != size_t(-1) || limits_.per_file != size_t(-1)
+                || limits_.total != size_t(-1);
+        return *this;
+    }
+
+    template<class F> static std::string_view fmt2str(const F& fmt) {
+        if constexpr (requires { fmt.get(); })
+            return std::string_view(fmt.get().data(), fmt.get().size());
+        else
+            return std::string_view(format::string_view(fmt).data(), format::string_view(fmt).size());
+    }
+
+    /// Expects Diags::mutex_ to be locked.
+    void flush_() {
+        if (batch_.entries.empty()) return;
+
+        diags_.clear();
+        heads_.clear();
+        for (size_t i = 0, e = batch_.entries.size(); i != e; ++i) {
+            auto& entry = batch_.entries[i];
+            auto msg    = std::string_view(batch_.text.data() + entry.begin, entry.end - entry.begin);
+            diags_.emplace_back(Diag{entry.sev, entry.loc, entry.code, msg, {}});
+            if (entry.head) heads_.emplace_back(i);
+        }
+        for (auto i : heads_)
+            diags_[i].notes = std::span<const Diag>(diags_.data() + i + 1, batch_.entries[i].num_notes);
+
+        if (sort_) detail::stable_sort(heads_, [this](size_t i, size_t j) { return less(diags_[i], diags_[j]); });
+
+        for (auto i : heads_) sink_->diag(diags_[i]);
+        sink_->flush();
+        batch_.clear();
+    }
+
+    std::unique_ptr<DiagSink> sink_;
+    bool sort_         = false;
+    size_t batch_size_ = 0;
+    bool immediate_    = true;
+    Diag::Sev min_sev_ = Diag::Sev::Note;
+    std::vector<std::string_view> suppressed_;
+    size_t max_errors_ = size_t(-1);
+    std::atomic<size_t> num_errors_   = 0;
+    std::atomic<size_t> num_warnings_ = 0;
+    std::atomic<size_t> num_dropped_  = 0;
+    bool limited_ = false; ///< Any of Diags::limits_ enabled?
+    struct Limits {
+        struct LocKey {
+            const std::filesystem::path* path;
+            Pos begin, finis;
+            bool operator==(const LocKey&) const = default;
+        };
+        struct Hash {
+            size_t operator()(const LocKey& k) const {
+                auto h = std::hash<const void*>()(k.path);
+                h ^= (size_t(k.begin.row) << 48 | size_t(k.begin.col) << 32 | size_t(k.finis.row) << 16 | k.finis.col)
+                   + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+                return h;
+            }
+            size_t operator()(const std::pair<LocKey, std::string_view>& p) const {
+                return (*this)(p.first) ^ std::hash<std::string_view>()(p.second);
+            }
+        };
+
+        bool dedup      = false;
+        size_t per_loc  = size_t(-1);
+        size_t per_file = size_t(-1);
+        size_t total    = size_t(-1);
+        size_t num_total = 0;
+        std::unordered_map<LocKey, size_t, Hash> num_per_loc;
+        std::unordered_map<const std::filesystem::path*, size_t> num_per_file;
+        std::unordered_set<std::pair<LocKey, std::string_view>, Hash> seen;
+    } limits_;
+    std::mutex limits_mutex_;  ///< Protects Diags::limits_.
+    mutable std::mutex mutex_; ///< Protects Diags::batch_ and Diags::sink_.
+    Batch batch_;
+    std::vector<Diag> diags_;
+    std::vector<size_t> heads_;
+};
+
+/// Thread-local buffer for Diags.
+/// While alive, all Diag%nostics emitted to its Diags *from the constructing thread* go into this buffer without any
+/// locking; upon destruction (or Local::merge), they are moved to the Diags in one go.
+/// Use like this:
+/// ```
+/// driver.diags().sort(true).batch(0); // makes output independent of thread scheduling
+/// std::vector<std::thread> workers;
+/// for (auto& file : files)
+///     workers.emplace_back([&] {
+///         fe::Diags::Local local(driver.diags());
+///         compile(driver, file); // uses driver.err(...) as usual
+///     });
+/// for (auto& worker : workers) worker.join();
+/// ```
+/// Parallel output only is deterministic with Diags::sort, Diags::batch `0`, and without any filters or limits that
+/// count - Diags::max_errors, Diags::max_total, ... - as these drop whichever Diag%nostics come last.
+/// Emit notes from the same thread as their warning/error - best via a Diags::Local.
+class Diags::Local {
+public:
+    Local(Diags& diags)
+        : diags_(diags)
+        , prev_(current_) {
+        current_ = this;
+    }
+    Local(const Local&)            = delete;
+    Local& operator=(const Local&) = delete;
+    ~Local() {
+        merge();
+        current_ = prev_;
+    }
+
+    /// Moves all buffered Diag%nostics to the Diags.
+    void merge() {
+        if (batch_.entries.empty()) return;
+        std::lock_guard lock(diags_.mutex_);
+        if (diags_.batch_size_ != 0 && diags_.batch_.num_heads >= diags_.batch_size_) diags_.flush_();
+        diags_.batch_.append(batch_);
+        if (diags_.immediate_) diags_.flush_(), diags_.sink_->sync();
+    }
+
+private:
+    Diags& diags_;
+    Local* prev_;
+    Batch batch_;
+    static inline thread_local Local* current_ = nullptr;
+
+    friend class Diags;
+};
+
+template<class... Args>
+bool Diags::emit_(Diag::Sev sev,
+                  std::string_view code,
+                  Loc loc,
+                  std::string_view id,
+                  format::format_string<Args...> fmt,
+                  Args&&... args) {
+    auto local = Local::current_;
+    if (local != nullptr && &local->diags_ != this) local = nullptr;
+
+    std::unique_lock<std::mutex> lock;
+    if (local == nullptr) lock = std::unique_lock(mutex_);
+    auto& batch = local ? local->batch_ : batch_;
+
+    if (!admit(batch, sev, code, loc, id)) {
+        if (sev != Diag::Sev::Note) {
+            batch.drop_notes = true;
+            ++num_dropped_;
+        }
+        return false;
+    }
+
+    if (sev != Diag::Sev::Note) {
+        batch.drop_notes = false;
+        if (sev == Diag::Sev::Warn) ++num_warnings_; // Diags::admit already counted an error
+        // No more notes can come for the pending warnings/errors - so they can go now.
+        if (local == nullptr && batch_size_ != 0 && batch.num_heads >= batch_size_) flush_();
+    }
+
+    batch.add(sev, code, loc, fmt, std::forward<Args&&>(args)...);
+    if (local == nullptr && immediate_) flush_(), sink_->sync();
+    return true;
+}
+
+/// @name is_lazy
+/// Can DeferredDiags capture an argument of type @p T by value instead of formatting it right away?
+/// This is the case for arithmetic types, `enum`s, Sym, Pos, Loc, and utf8::Char32.
+/// Specialize for your own types that are cheap to copy and do not point to data that may die in the meantime:
+/// ```
+/// template<> struct fe::is_lazy<Tok> : std::true_type {};
+/// ```
+///@{
+template<class T> struct is_lazy : std::bool_constant<std::is_arithmetic_v<T> || std::is_enum_v<T>> {};
+template<> struct is_lazy<Sym> : std::true_type {};
+template<> struct is_lazy<Pos> : std::true_type {};
+template<> struct is_lazy<Loc> : std::true_type {};
+template<> struct is_lazy<utf8::Char32> : std::true_type {};
+template<class T> inline constexpr bool is_lazy_v = is_lazy<std::remove_cvref_t<T>>::value;
+///@}
+
+/// Records Diag%nostics in an Arena *without* formatting them.
+/// Only upon DeferredDiags::commit, they are formatted and emitted to a Diags.
+/// If all arguments are fe::is_lazy, they are just copied; otherwise, the message is formatted right away.
+/// In both cases, the code and Loc::path are *not* copied: As with Diags::emit, they must outlive the Diags you
+/// eventually commit to - e.g. a string literal as code.
+/// Likewise, fe::is_lazy arguments are copied but not what they point to - like the string of a Sym.
+/// DeferredDiags::rollback discards everything recorded after a DeferredDiags::state - at no cost:
+/// ```
+/// fe::DeferredDiags deferred;
+/// auto state = deferred.state();
+/// deferred.emit(fe::Diag::Sev::Err, {}, loc, "expected '{}'", sym); // no formatting
+/// if (/* speculation failed */) deferred.rollback(state);
+/// else deferred.commit(diags);
+/// ```
+/// Usually, you will use Driver::Speculation instead.
+class DeferredDiags {
+private:
+    struct Record {
+        Record* next = nullptr;
+        bool (*replay)(Diags&, const Record*);
+        Diag::Sev sev;
+        std::string_view code;
+        Loc loc;
+    };
+
+public:
+    static constexpr size_t Default_Page_Size = 64 * 1024; ///< 64KB.
+
+    /// @name Construction
+    ///@{
+    DeferredDiags(size_t page_size = Default_Page_Size)
+        : arena_(page_size)
+        , init_(arena_.state()) {}
+    DeferredDiags(const DeferredDiags&)            = delete;
+    DeferredDiags& operator=(const DeferredDiags&) = delete;
+    ///@}
+
+    /// @name State
+    ///@{
+    struct State {
+        Arena::State arena;
+        Record* tail;
+        size_t size;
+    };
+
+    State state() const { return {arena_.state(), tail_, size_}; }
+
+    /// Discards everything recorded after @p state.
+    void rollback(State state) {
+        arena_.deallocate(state.arena);
+        tail_ = state.tail;
+        size_ = state.size;
+        (tail_ ? tail_->next : head_) = nullptr;
+    }
+
+    void clear() { rollback({init_, nullptr, 0}); } ///< Discards everything.
+    size_t size() const { return size_; }          ///< Number of recorded Diag%nostics.
+    ///@}
+
+    /// Records a Diag%nostic; see Diags::emit - in particular regarding the lifetime of @p code.
+    template<class... Args>
+    void emit(Diag::Sev sev, std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+        Record* record;
+        if constexpr ((is_lazy_v<Args> && ...)) {
+            using Lazy = LazyRecord<format::format_string<Args...>, std::remove_cvref_t<Args>...>;
+            static_assert(std::is_trivially_destructible_v<Lazy>);
+            record = new (arena_.allocate<Lazy>(1))
+                Lazy{{nullptr, &Lazy::template replay<Args...>, sev, code, loc}, fmt, {std::forward<Args&&>(args)...}};
+        } else {
+            auto str = format::format(fmt, std::forward<Args&&>(args)...);
+            auto msg = arena_.allocate<char>(str.size());
+            str.copy(msg, str.size());
+            record = new (arena_.allocate<Eager>(1)) Eager{
+                {nullptr, &Eager::replay, sev, code, loc}, Diags::fmt2str(fmt), std::string_view(msg, str.size())};
+        }
+
+        (tail_ ? tail_->next : head_) = record;
+        tail_                         = record;
+        ++size_;
+    }
+
+    /// Formats and emits everything recorded after @p from to @p diags, and then discards it.
+    /// Invokes `f(sev, recorded)` for each Diag%nostic where `recorded` is the result of Diags::emit.
+    template<class F> void commit(State from, Diags& diags, F f) {
+        for (auto r = from.tail ? from.tail->next : head_; r != nullptr; r = r->next) f(r->sev, r->replay(diags, r));
+        rollback(from);
+    }
+
+    void commit(State from, Diags& diags) { commit(from, diags, [](Diag::Sev, bool) {}); }
+    template<class F> void commit(Diags& diags, F f) { commit({init_, nullptr, 0}, diags, f); }
+    void commit(Diags& diags) { commit(diags, [](Diag::Sev, bool) {}); }
+
+private:
+    template<class F, class... Ts> struct LazyRecord : Record {
+        F fmt;
+        std::tuple<Ts...> args;
+
+        template<class... Args> static bool replay(Diags& diags, const Record* record) {
+            auto lazy = static_cast<const LazyRecord*>(record);
+            return std::apply(
+                [&](auto... args) {
+                    return diags.emit_<Args...>(lazy->sev, lazy->code, lazy->loc, Diags::fmt2str(lazy->fmt), lazy->fmt,
+                                                std::forward<Args>(args)...);
+                },
+                lazy->args);
+        }
+    };
+
+    struct Eager : Record {
+        std::string_view id;
+        std::string_view msg;
+
+        static bool replay(Diags& diags, const Record* record) {
+            auto eager = static_cast<const Eager*>(record);
+            return diags.emit_(eager->sev, eager->code, eager->loc, eager->id, "{}", eager->msg);
+        }
+    };
+
+    Arena arena_;
+    Arena::State init_;
+    Record* head_ = nullptr;
+    Record* tail_ = nullptr;
+    size_t size_  = 0;
+};
+
+} // namespace fe
@@ -0,0 +1,182 @@
+#pragma once
+
+/// @file
+/// Machine-readable DiagSink%s - JsonSink and SarifSink - kept apart from fe/diag.h so a Driver does not have to
+/// compile them.
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "fe/diag.h"
+#include "fe/json.h"
+
+namespace fe {
+
+namespace detail::json {
+inline void path(std::string& out, const std::filesystem::path* path) {
+    if (path)
+        str(out, path2str(*path));
+    else
+        out += "null";
+}
+} // namespace detail::json
+
+/// One JSON object per line and per Diag%nostic:
+/// ```json
+/// {"severity":"error","code":"E1","file":"a.let","begin":[1,2],"finis":[1,5],"message":"...","notes":[...]}
+/// ```
+/// `"code"` is omitted if the Diag%nostic has none.
+class JsonSink : public DiagSink {
+public:
+    JsonSink(detail::Output out)
+        : dst_(out) {}
+
+    void diag(const Diag& diag) override {
+        render(diag, false);
+        out_ += '\n';
+    }
+
+    void flush() override {
+        dst_.write(out_);
+        out_.clear();
+    }
+
+    void sync() override { dst_.flush(); }
+
+    /// `{"summary":{"errors":2,"warnings":1,"suppressed":5}}`
+    void summary(size_t num_errors, size_t num_warnings, size_t num_suppressed) override {
+        format::format_to(std::back_inserter(out_), R"({{"summary":{{"errors":{},"warnings":{},"suppressed":{}}}}})",
+                          num_errors, num_warnings, num_suppressed);
+        out_ += '\n';
+        flush();
+    }
+
+private:
+    void render(const Diag& diag, bool note) {
+        out_ += "{\"severity\":";
+        detail::json::str(out_, Diag::sev2str(diag.sev));
+        if (!diag.code.empty()) {
+            out_ += ",\"code\":";
+            detail::json::str(out_, diag.code);
+        }
+        out_ += ",\"file\":";
+        detail::json::path(out_, diag.loc.path);
+        format::format_to(std::back_inserter(out_), ",\"begin\":[{},{}],\"finis\":[{},{}],\"message\":",
+                          diag.loc.begin.row, diag.loc.begin.col, diag.loc.finis.row, diag.loc.finis.col);
+        detail::json::str(out_, diag.msg);
+        if (!note) {
+            out_ += ",\"notes\":[";
+            for (bool sep = false; const auto& n : diag.notes) {
+                if (sep) out_ += ',';
+                render(n, true);
+                sep = true;
+            }
+            out_ += ']';
+        }
+        out_ += '}';
+    }
+
+    detail::Output dst_;
+    std::string out_;
+};
+
+/// [SARIF 2.1.0](https://docs.oasis-open.org/sarif/sarif/v2.1.0/sarif-v2.1.0.html) log.
+/// A SARIF log is a single JSON document; so results are collected across batches and written upon destruction.
+/// Notes become `relatedLocations`; `ruleId` is omitted if the Diag%nostic has no code.
+/// An `artifactLocation` refers to Loc::path via SarifSink::uri and is empty if there is none.
+class SarifSink : public DiagSink {
+public:
+    SarifSink(detail::Output out, std::string_view tool = "fe")
+        : dst_(out) {
+        out_ = R"({"version":"2.1.0","$schema":"https://json.schemastore.org/sarif-2.1.0.json",)"
+               R"("runs":[{"tool":{"driver":{"name":)";
+        detail::json::str(out_, tool);
+        out_ += R"(}},"results":[)";
+    }
+    ~SarifSink() override {
+        out_ += "]}]}\n";
+        dst_.write(out_);
+        dst_.flush();
+    }
+
+    /// Appends @p path to @p out as URI: a relative path as relative reference, an absolute one as `file:` URI.
+    /// Either way with `/` as separator; bytes of the UTF-8 encoding other than unreserved characters are
+    /// percent-encoded.
+    static void uri(std::string& out, const std::filesystem::path& path) {
+        bool drive = path.is_absolute() && path.has_root_name(); // C:/a.let -> file:///C:/a.let
+        if (path.is_absolute()) out += drive ? "file:///" : "file://";
+        auto str = path.generic_u8string();
+        for (size_t i = 0, e = str.size(); i != e; ++i) {
+            auto c = char(str[i]);
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.'
+                || c == '_' || c == '~' || c == '/' || (c == ':' && drive && i == 1))
+                out += c;
+            else
+                format::format_to(std::back_inserter(out), "%{:02X}", (unsigned char)c);
+        }
+    }
+
+    void diag(const Diag& diag) override {
+        if (sep_) out_ += ',';
+        sep_ = true;
+        out_ += '{';
+        if (!diag.code.empty()) {
+            out_ += R"("ruleId":)";
+            detail::json::str(out_, diag.code);
+            out_ += ',';
+        }
+        out_ += R"("level":)";
+        detail::json::str(out_, diag.sev == Diag::Sev::Err  ? "error"
+                              : diag.sev == Diag::Sev::Warn ? "warning"
+                                                            : "note");
+        out_ += R"(,"message":)";
+        message(diag.msg);
+        out_ += R"(,"locations":[)";
+        location(diag.loc);
+        out_ += R"(],"relatedLocations":[)";
+        for (bool sep = false; const auto& note : diag.notes) {
+            if (sep) out_ += ',';
+            location(note.loc, note.msg);
+            sep = true;
+        }
+        out_ += "]}";
+    }
+
+private:
+    void message(std::string_view msg) {
+        out_ += R"({"text":)";
+        detail::json::str(out_, msg);
+        out_ += '}';
+    }
+
+    void location(Loc loc, std::string_view msg = {}) {
+        out_ += R"({"physicalLocation":{"artifactLocation":{)";
+        if (loc.path) {
+            out_ += R"("uri":")";
+            uri(out_, *loc.path); // nothing to escape for JSON
+            out_ += '"';
+        }
+        out_ += '}';
+        if (loc)
+            format::format_to(std::back_inserter(out_),
+                              R"(,"region":{{"startLine":{},"startColumn":{},"endLine":{},"endColumn":{}}})",
+                              loc.begin.row, std::max(loc.begin.col, uint16_t(1)),
+                              std::max(loc.finis.row, loc.begin.row),
+                              loc.finis.col + 1); // SARIF's endColumn is exclusive
+        out_ += '}';
+        if (!msg.empty()) {
+            out_ += R"(,"message":)";
+            message(msg);
+        }
+        out_ += '}';
+    }
+
+    detail::Output dst_;
+    std::string out_;
+    bool sep_ = false;
+};
+
+} // namespace fe
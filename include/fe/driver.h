@@ -1,40 +1,171 @@
 #pragma once
 
-#include <sstream>
+#include <memory>
 #include <string_view>
+#include <vector>
 
+#include <fe/diag.h>
 #include <fe/format.h>
 #include <fe/loc.h>
+#include <fe/source.h>
 #include <fe/sym.h>
+#include <fe/trace.h>
 
 namespace fe {
 
 /// Use/derive from this class for "global" variables that you need all over the place.
 /// Well, there are not really global - that's the point of this class.
 /// Right now, it manages a SymPool (by inherting from it) and offers `std::format`-based diagnostics.
+/// Diag%nostics go through Diags: By default, each one is written and flushed right away (Diags::immediate);
+/// opt in to Diags::batch for writing them in batches upon Driver::flush or destruction.
 struct Driver : public SymPool {
 public:
+    /// @name Construction
+    ///@{
+    Driver() = default;
+    /// @warning Don't move a Driver while a Driver::Speculation or a Diags::Local refers to it.
+    /// A DiagSink that points to Driver::sources - like a TextSink with snippets - still points to those of @p other.
+    Driver(Driver&& other) noexcept
+        : SymPool(std::move(other))
+        , sources_(std::move(other.sources_))
+        , diags_(std::move(other.diags_)) {}
+    ///@}
+
     /// @name Diagnostics
+    /// Optionally, pass a @p code like `"W0815"` first which you can use to filter Diag%nostics via Driver::diags.
+    /// @p code is not copied and must outlive the Driver - use a string literal; see Diags::emit.
+    /// Filtered Diag%nostics are never formatted.
+    /// Driver::num_errors and Driver::num_warnings are those of Driver::diags: They only count what passed all filters
+    /// and limits - so a suppressed error doesn't count and Diags::max_errors caps Driver::num_errors.
+    /// All of them are thread-safe; see Diags::Local for parallel workers.
+    /// Within a Driver::Speculation, they are only recorded and neither formatted nor accounted for until committed.
     ///@{
-    template<class... Args> static void note(Loc loc, format::format_string<Args...> fmt, Args&&... args) {
-        std::cerr << loc << ": note: " << format::format(fmt, std::forward<Args&&>(args)...) << std::endl;
+    template<class... Args>
+    void note(std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+        emit(Diag::Sev::Note, code, loc, fmt, std::forward<Args&&>(args)...);
     }
-    template<class... Args> void warn(Loc loc, format::format_string<Args...> fmt, Args&&... args) {
-        ++num_warnings_;
-        std::cerr << loc << ": warning: " << format::format(fmt, std::forward<Args&&>(args)...) << std::endl;
+    template<class... Args>
+    void warn(std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+        emit(Diag::Sev::Warn, code, loc, fmt, std::forward<Args&&>(args)...);
     }
-    template<class... Args> void err(Loc loc, format::format_string<Args...> fmt, Args&&... args) {
-        ++num_errors_;
-        std::cerr << loc << ": error: " << format::format(fmt, std::forward<Args&&>(args)...) << std::endl;
+    template<class... Args>
+    void err(std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+        emit(Diag::Sev::Err, code, loc, fmt, std::forward<Args&&>(args)...);
     }
 
-    unsigned num_errors() const { return num_errors_; }
-    unsigned num_warnings() const { return num_warnings_; }
+    // clang-format off
+    template<class... Args> void note(Loc loc, format::format_string<Args...> fmt, Args&&... args) { note({}, loc, fmt, std::forward<Args&&>(args)...); }
+    template<class... Args> void warn(Loc loc, format::format_string<Args...> fmt, Args&&... args) { warn({}, loc, fmt, std::forward<Args&&>(args)...); }
+    template<class... Args> void err (Loc loc, format::format_string<Args...> fmt, Args&&... args) { err ({}, loc, fmt, std::forward<Args&&>(args)...); }
+    // clang-format on
+
+    unsigned num_errors() const { return unsigned(diags_.num_errors()); }     ///< See Diags::num_errors.
+    unsigned num_warnings() const { return unsigned(diags_.num_warnings()); } ///< See Diags::num_warnings.
+
+    Diags& diags() { return diags_; }
+    /// Use this together with a TextSink to show source snippets:
+    /// ```
+    /// driver.diags().sink(std::make_unique<fe::TextSink>(std::cerr, &driver.sources()));
+    /// ```
+    SourceCache& sources() { return sources_; }
+    void flush() { diags_.flush(); } ///< Emits all pending Diag%nostics.
     ///@}
 
+    class Speculation;
+
 private:
-    unsigned num_errors_   = 0;
-    unsigned num_warnings_ = 0;
+    template<class... Args>
+    void emit(Diag::Sev sev, std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args);
+
+    SourceCache sources_; // must outlive diags_
+    Diags diags_;
 };
 
+/// Speculative parsing: While a Speculation is alive, all Diag%nostics issued via its Driver on the *current thread*
+/// are merely recorded in a DeferredDiags - they are neither formatted nor accounted for in Driver::num_errors.
+/// Unless you Speculation::commit, they are discarded upon destruction:
+/// ```
+/// if (fe::Driver::Speculation spec(driver); auto expr = parse_cast_expr()) {
+///     spec.commit(); // now, all Diag%nostics issued by parse_cast_expr are formatted and emitted
+///     return expr;
+/// } // otherwise, they are gone - for free
+/// return parse_paren_expr();
+/// ```
+/// Speculation%s nest: Committing an inner Speculation hands its Diag%nostics over to the outer one.
+/// Speculation%s of different Driver%s may nest as well; each Driver records into its own DeferredDiags.
+class Driver::Speculation {
+public:
+    /// @name Construction/Destruction
+    ///@{
+    Speculation(Driver& driver)
+        : driver_(driver)
+        , prev_(current_)
+        , outer_(active(driver))
+        , own_(outer_ ? nullptr : acquire())
+        , log_(outer_ ? outer_->log_ : own_.get())
+        , state_(log_->state()) {
+        current_ = this;
+    }
+    Speculation(const Speculation&) = delete;
+    Speculation& operator=(const Speculation&) = delete;
+    ~Speculation() {
+        if (!committed_) log_->rollback(state_);
+        if (own_) pool().emplace_back(std::move(own_)); // empty again
+        current_ = prev_;
+    }
+    ///@}
+
+    /// Keeps all Diag%nostics recorded so far - they are emitted once the outermost Speculation commits.
+    /// @warning Inner Speculation%s must not be alive anymore.
+    void commit() {
+        if (committed_) return;
+        committed_ = true;
+        if (outer_ == nullptr) log_->commit(state_, driver_.diags_);
+    }
+
+    size_t num_pending() const { return log_->size() - state_.size; } ///< Diag%nostics recorded so far.
+
+private:
+    /// The innermost Speculation of @p driver on this thread.
+    static Speculation* active(const Driver& driver) {
+        for (auto spec = current_; spec != nullptr; spec = spec->prev_)
+            if (&spec->driver_ == &driver) return spec;
+        return nullptr;
+    }
+
+    /// The DeferredDiags of outermost Speculation%s that have ended - for reuse on this thread.
+    static std::vector<std::unique_ptr<DeferredDiags>>& pool() {
+        static thread_local std::vector<std::unique_ptr<DeferredDiags>> pool;
+        return pool;
+    }
+
+    static std::unique_ptr<DeferredDiags> acquire() {
+        auto& p = pool();
+        if (p.empty()) return std::make_unique<DeferredDiags>();
+        auto log = std::move(p.back());
+        p.pop_back();
+        return log;
+    }
+
+    Driver& driver_;
+    Speculation* prev_;
+    Speculation* outer_;
+    std::unique_ptr<DeferredDiags> own_; ///< Only set for the outermost Speculation of driver_.
+    DeferredDiags* log_;                 ///< Shared by all nested Speculation%s of driver_.
+    DeferredDiags::State state_;
+    bool committed_ = false;
+    static inline thread_local Speculation* current_ = nullptr;
+
+    friend struct Driver;
+};
+
+template<class... Args>
+void Driver::emit(Diag::Sev sev, std::string_view code, Loc loc, format::format_string<Args...> fmt, Args&&... args) {
+    FE_TRACE_COUNT(Diags, 1);
+    if (auto spec = Speculation::current_ ? Speculation::active(*this) : nullptr)
+        spec->log_->emit(sev, code, loc, fmt, std::forward<Args&&>(args)...);
+    else
+        diags_.emit(sev, code, loc, fmt, std::forward<Args&&>(args)...);
+}
+
 } // namespace fe
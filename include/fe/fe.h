@@ -0,0 +1,30 @@
+#pragma once
+
+/// @file
+/// Includes all of FE - except fe/loc.cpp.h.
+/// Handy as precompiled header; see `fe-pch` in the top-level `CMakeLists.txt`.
+
+#include "fe/arena.h"
+#include "fe/assert.h"
+#include "fe/ast.h"
+#include "fe/cast.h"
+#include "fe/diag.h"
+#include "fe/diag_sinks.h"
+#include "fe/driver.h"
+#include "fe/enum.h"
+#include "fe/format.h"
+#include "fe/format_core.h"
+#include "fe/fragments.h"
+#include "fe/fwd.h"
+#include "fe/hash_cons.h"
+#include "fe/json.h"
+#include "fe/lexer.h"
+#include "fe/loc.h"
+#include "fe/parser.h"
+#include "fe/ring.h"
+#include "fe/scope_table.h"
+#include "fe/source.h"
+#include "fe/sym.h"
+#include "fe/trace.h"
+#include "fe/utf8.h"
+#include "fe/writer.h"
@@ -1,25 +1,15 @@
 #pragma once
 
-#ifdef FE_STD_FORMAT_SUPPORT
-#    include <format>
-#else
-#    include <fmt/format.h>
-#endif
+#include <iostream>
+#include <sstream>
+#include <string_view>
 
-#include "fe/loc.h"
-#include "fe/utf8.h"
+#include "fe/format_core.h"
 
 namespace fe {
 
-namespace format {
-#ifdef FE_STD_FORMAT_SUPPORT
-using namespace ::std;
-#else
-using namespace ::fmt;
-#endif
-} // namespace format
-
 /// Make types that support ostream operators available for `std::format`.
+/// @note This constructs a `std::stringstream` for each formatted value; prefer direct_formatter in hot code.
 /// Use like this:
 /// ```
 /// template<> struct std::formatter<T> : fe::ostream_formatter {};
@@ -48,63 +38,6 @@ template<class... Args> void out  (format::format_string<Args...> fmt, Args&&...
 template<class... Args> void errln(format::format_string<Args...> fmt, Args&&... args) { std::cerr << format::format(fmt, std::forward<Args&&>(args)...) << std::endl; }
 template<class... Args> void outln(format::format_string<Args...> fmt, Args&&... args) { std::cout << format::format(fmt, std::forward<Args&&>(args)...) << std::endl; }
 // clang-format on
-
-/// Keeps track of indentation level during output
-class Tab {
-public:
-    Tab(const Tab&) = default;
-    Tab(std::string_view tab = {"\t"}, size_t indent = 0)
-        : tab_(tab)
-        , indent_(indent) {}
-
-    /// @name Getters
-    ///@{
-    size_t indent() const { return indent_; }
-    std::string_view tab() const { return tab_; }
-    ///@}
-
-    /// @name Setters
-    ///@{
-    Tab& operator=(size_t indent) {
-        indent_ = indent;
-        return *this;
-    }
-    Tab& operator=(std::string tab) {
-        tab_ = tab;
-        return *this;
-    }
-    ///@}
-
-    // clang-format off
-    /// @name Indent/Dedent
-    ///@{
-    Tab& operator++() {                      ++indent_; return *this; }
-    Tab& operator--() { assert(indent_ > 0); --indent_; return *this; }
-    Tab& operator+=(size_t indent) {                      indent_ += indent; return *this; }
-    Tab& operator-=(size_t indent) { assert(indent_ > 0); indent_ -= indent; return *this; }
-    Tab  operator++(int) {                      auto res = *this; ++indent_; return res; }
-    Tab  operator--(int) { assert(indent_ > 0); auto res = *this; --indent_; return res; }
-    Tab  operator+(size_t indent) const {                      return {tab_, indent_ + indent}; }
-    Tab  operator-(size_t indent) const { assert(indent_ > 0); return {tab_, indent_ - indent}; }
-    ///@}
-    // clang-format on
-
-    friend std::ostream& operator<<(std::ostream& os, Tab tab) {
-        for (size_t i = 0; i != tab.indent_; ++i) os << tab.tab_;
-        return os;
-    }
-
-private:
-    std::string_view tab_;
-    size_t indent_ = 0;
-};
+///@}
 
 } // namespace fe
-
-#ifndef DOXYGEN
-template<> struct fe::format::formatter<fe::Pos> : fe::ostream_formatter {};
-template<> struct fe::format::formatter<fe::Loc> : fe::ostream_formatter {};
-template<> struct fe::format::formatter<fe::Sym> : fe::ostream_formatter {};
-template<> struct fe::format::formatter<fe::Tab> : fe::ostream_formatter {};
-template<> struct fe::format::formatter<fe::utf8::Char32> : fe::ostream_formatter {};
-#endif
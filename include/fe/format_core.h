@@ -0,0 +1,190 @@
+#pragma once
+
+/// @file
+/// fe/format.h without fe::out & co. and fe::ostream_formatter - and hence, without `<iostream>` and `<sstream>`.
+/// Opt in to this header where you only need `std::format`-based formatting of FE's types.
+
+#ifdef FE_STD_FORMAT_SUPPORT
+#    include <format>
+#else
+#    include <fmt/format.h>
+#endif
+
+#include <iosfwd>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "fe/loc.h"
+#include "fe/utf8.h"
+
+namespace fe {
+
+namespace format {
+#ifdef FE_STD_FORMAT_SUPPORT
+using namespace ::std;
+#else
+using namespace ::fmt;
+#endif
+} // namespace format
+
+namespace detail {
+template<class O> O write(O out, std::string_view s) {
+    for (auto c : s) *out++ = c; // std::ranges::copy needs <algorithm>
+    return out;
+}
+
+struct MemberWriter {
+    template<class O, class T> O operator()(O out, const T& value) const { return value.format_to(out); }
+};
+} // namespace detail
+
+/// Make types available for `std::format` that write themselves directly to the output -
+/// without the `std::stringstream` round trip of fe::ostream_formatter.
+/// @p T must provide a member `template<class O> O format_to(O out) const` that writes to the output iterator `out`
+/// and returns the advanced iterator.
+/// Alternatively, pass a function object @p F with `template<class O> O operator()(O out, const T& value) const`.
+/// Use like this:
+/// ```
+/// struct Tok {
+///     template<class O> O format_to(O out) const { return fe::format::format_to(out, "{}", sym_); }
+///     // ...
+/// };
+///
+/// template<> struct fe::format::formatter<Tok> : fe::direct_formatter<Tok> {};
+/// ```
+/// If no format spec is given, @p T is written straight into the output.
+/// Otherwise, @p T is formatted into a temporary first and the spec is applied like for a `std::string_view`.
+template<class T, class F = detail::MemberWriter> struct direct_formatter : format::formatter<std::string_view> {
+    template<class Ctx> constexpr auto parse(Ctx& ctx) {
+        plain_ = ctx.begin() == ctx.end() || *ctx.begin() == '}';
+        return format::formatter<std::string_view>::parse(ctx);
+    }
+
+    template<class Ctx> auto format(const T& value, Ctx& ctx) const {
+        if (plain_) return F()(ctx.out(), value);
+        std::string str;
+        F()(std::back_inserter(str), value);
+        return format::formatter<std::string_view>::format(str, ctx);
+    }
+
+private:
+    bool plain_ = true;
+};
+
+/// Keeps track of indentation level during output
+class Tab {
+public:
+    Tab(const Tab&) = default;
+    Tab(std::string_view tab = {"\t"}, size_t indent = 0)
+        : tab_(tab)
+        , indent_(indent) {}
+
+    /// @name Getters
+    ///@{
+    size_t indent() const { return indent_; }
+    std::string_view tab() const { return tab_; }
+
+    /// The whole indentation - i.e. Tab::tab repeated Tab::indent times - as one string.
+    /// The result is taken from a per-thread cache; so after warm-up, this neither allocates nor loops.
+    /// @warning The result is only valid until the next invocation of this method on the same thread.
+    std::string_view str() const {
+        static thread_local std::string unit, cache;
+        if (unit != tab_) unit = tab_, cache.clear();
+        auto size = indent_ * tab_.size();
+        while (cache.size() < size) cache += tab_;
+        return std::string_view(cache).substr(0, size);
+    }
+    ///@}
+
+    /// @name Setters
+    ///@{
+    Tab& operator=(size_t indent) {
+        indent_ = indent;
+        return *this;
+    }
+    Tab& operator=(std::string tab) {
+        tab_ = tab;
+        return *this;
+    }
+    ///@}
+
+    // clang-format off
+    /// @name Indent/Dedent
+    ///@{
+    Tab& operator++() {                      ++indent_; return *this; }
+    Tab& operator--() { assert(indent_ > 0); --indent_; return *this; }
+    Tab& operator+=(size_t indent) {                      indent_ += indent; return *this; }
+    Tab& operator-=(size_t indent) { assert(indent_ > 0); indent_ -= indent; return *this; }
+    Tab  operator++(int) {                      auto res = *this; ++indent_; return res; }
+    Tab  operator--(int) { assert(indent_ > 0); auto res = *this; --indent_; return res; }
+    Tab  operator+(size_t indent) const {                      return {tab_, indent_ + indent}; }
+    Tab  operator-(size_t indent) const { assert(indent_ > 0); return {tab_, indent_ - indent}; }
+    ///@}
+    // clang-format on
+
+    template<class Traits> // avoids `#include <ostream>`
+    friend std::basic_ostream<char, Traits>& operator<<(std::basic_ostream<char, Traits>& os, Tab tab) {
+        return os << tab.str();
+    }
+
+private:
+    std::string_view tab_;
+    size_t indent_ = 0;
+};
+
+namespace detail {
+struct PosWriter {
+    template<class O> O operator()(O out, Pos pos) const {
+        if (pos.row) {
+            if (pos.col) return format::format_to(out, "{}:{}", pos.row, pos.col);
+            return format::format_to(out, "{}", pos.row);
+        }
+        return write(out, "<unknown position>");
+    }
+};
+
+struct LocWriter {
+    template<class O> O operator()(O out, Loc loc) const {
+        if (loc) {
+            out    = write(out, loc.path ? path2str(*loc.path) : "<unknown file>");
+            *out++ = ':';
+            out    = PosWriter()(out, loc.begin);
+            if (loc.begin != loc.finis) {
+                *out++ = '-';
+                out    = PosWriter()(out, loc.finis);
+            }
+            return out;
+        }
+        return write(out, "<unknown location>");
+    }
+};
+
+struct TabWriter {
+    template<class O> O operator()(O out, Tab tab) const { return write(out, tab.str()); }
+};
+
+struct Char32Writer {
+    template<class O> O operator()(O out, utf8::Char32 c) const {
+        char buf[utf8::Max];
+        auto n = utf8::encode(buf, c.c);
+        assert_unused(n != 0);
+        return write(out, std::string_view(buf, n));
+    }
+};
+} // namespace detail
+
+} // namespace fe
+
+#ifndef DOXYGEN
+template<> struct fe::format::formatter<fe::Pos> : fe::direct_formatter<fe::Pos, fe::detail::PosWriter> {};
+template<> struct fe::format::formatter<fe::Loc> : fe::direct_formatter<fe::Loc, fe::detail::LocWriter> {};
+template<> struct fe::format::formatter<fe::Tab> : fe::direct_formatter<fe::Tab, fe::detail::TabWriter> {};
+template<>
+struct fe::format::formatter<fe::utf8::Char32> : fe::direct_formatter<fe::utf8::Char32, fe::detail::Char32Writer> {};
+template<> struct fe::format::formatter<fe::Sym> : fe::format::formatter<std::string_view> {
+    template<class Ctx> auto format(fe::Sym sym, Ctx& ctx) const {
+        return fe::format::formatter<std::string_view>::format(sym.view(), ctx);
+    }
+};
+#endif
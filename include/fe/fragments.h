@@ -0,0 +1,102 @@
+#pragma once
+
+/// @file
+/// Parallel rendering via Fragments - kept apart from fe/writer.h so a Writer does not have to compile `<thread>`.
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fe/writer.h"
+
+namespace fe {
+
+/// Renders independent output fragments - e.g. one per function - on several threads and concatenates them afterwards
+/// in their original order.
+/// Each fragment goes into its own in-memory Writer and gets its own copy of a Tab.
+/// Hence, the result is exactly the same as if all fragments were rendered serially.
+/// Use like this:
+/// ```
+/// fe::Fragments fragments(fns.size());
+/// fragments.render([&](size_t i, fe::Writer& w, fe::Tab& tab) { print(w, tab, fns[i]); });
+/// fragments.write(std::cout); // a single large write
+/// ```
+class Fragments {
+public:
+    Fragments(size_t n, Tab tab = {})
+        : writers_(n)
+        , tab_(tab) {}
+
+    size_t size() const { return writers_.size(); }
+    Writer& operator[](size_t i) { return writers_[i]; }
+    const Writer& operator[](size_t i) const { return writers_[i]; }
+
+    /// Invokes `f(i, writer, tab)` for each fragment `i` on @p num_threads threads.
+    /// Threads grab the next pending fragment as soon as they are done with the previous one.
+    /// If @p f throws, the first exception is rethrown after all threads have finished.
+    template<class F> void render(F f, size_t num_threads = std::thread::hardware_concurrency()) {
+        std::atomic<size_t> next = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+
+        auto work = [&] {
+            for (size_t i; (i = next++) < size();) {
+                try {
+                    auto tab = tab_;
+                    f(i, writers_[i], tab);
+                } catch (...) {
+                    std::lock_guard lock(mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        };
+
+        num_threads = std::min(num_threads, size());
+        if (num_threads <= 1) {
+            work();
+        } else {
+            // std::thread instead of std::jthread as libc++ 16 doesn't have the latter
+            std::vector<std::thread> threads;
+            auto join = [&] {
+                for (auto& thread : threads) thread.join();
+            };
+            try {
+                for (size_t i = 0; i != num_threads; ++i) threads.emplace_back(work);
+            } catch (...) {
+                join(); // the threads that did start still finish all fragments
+                throw;
+            }
+            join();
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    /// Gathers all fragments in order and writes them to @p os with a single `write` - then flushes it.
+    /// One `write` per fragment would avoid this copy, but small fragments then trickle through the stream buffer one
+    /// by one; see `fe-bench --filter Fragments`.
+    void write(std::ostream& os) const {
+        size_t size = 0;
+        for (const auto& w : writers_) size += w.view().size();
+        std::string buf;
+        buf.reserve(size);
+        for (const auto& w : writers_) buf += w.view();
+        os.write(buf.data(), std::streamsize(buf.size()));
+        os.flush();
+    }
+
+    /// Appends all fragments in order to @p w.
+    void write(Writer& w) const {
+        for (const auto& fragment : writers_) w.write(fragment.view());
+    }
+
+private:
+    std::vector<Writer> writers_;
+    Tab tab_;
+};
+
+} // namespace fe
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+/// @file
+/// Forward declarations of FE's classes.
+/// Include this instead of the actual headers in your own headers whenever a declaration suffices - e.g., for
+/// pointers, references, or function signatures - to keep your compile times down.
+
+namespace fe {
+
+class Arena;
+template<class B> class AST;
+template<class B> class ASTNode;
+template<class B> class RuntimeCast;
+struct Diag;
+class DiagSink;
+class Diags;
+class DeferredDiags;
+struct Driver;
+class Fragments;
+template<class B, class Hash, class Equal> class HashCons;
+template<size_t K, class S> class Lexer;
+struct Loc;
+struct Pos;
+template<class T, size_t N> class Ring;
+template<class V> class ScopeTable;
+class Source;
+class SourceCache;
+class Sym;
+class SymPool;
+class Tab;
+class Writer;
+
+namespace utf8 {
+struct Char32;
+}
+
+} // namespace fe
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+#ifdef FE_ABSL
+#    include <absl/container/flat_hash_set.h>
+#else
+#    include <unordered_set>
+#endif
+
+#include "fe/arena.h"
+
+namespace fe {
+
+/// [Hash-conses](https://en.wikipedia.org/wiki/Hash_consing) immutable nodes of the hierarchy rooted in @p B -
+/// just like SymPool does for strings:
+/// Structurally equal nodes are the *same* node, so comparing them is only a pointer comparison.
+/// HashCons::mk constructs a candidate in its Arena and looks it up via @p Hash and @p Equal.
+/// If an equal node already exists, HashCons::mk rolls back the candidate's allocation and returns the existing node.
+/// ```
+/// struct Type {
+///     enum class Tag { Bool, Int, Fn } tag;
+///     const Type* dom = nullptr; // already hash-consed, so
+///     const Type* cod = nullptr; // hash and compare the pointers - no need to recurse
+///     friend bool operator==(const Type&, const Type&) = default;
+/// };
+/// template<> struct std::hash<Type> { /*...*/ };
+///
+/// fe::HashCons<Type> types;
+/// auto i  = types.mk(Type::Tag::Int);
+/// auto fn = types.mk(Type::Tag::Fn, i, i);
+/// assert(fn == types.mk(Type::Tag::Fn, i, types.mk(Type::Tag::Int)));
+/// ```
+/// @p Hash and @p Equal operate on `const B&`; in a class hierarchy, they must take the actual class into account -
+/// e.g., via fe::visit.
+/// Node constructors may allocate variable-length payloads - e.g., the element types of a tuple type - from
+/// HashCons::arena; these will be rolled back as well.
+/// @warning Node constructors must *not* invoke HashCons::mk of the same HashCons:
+/// Rolling back a duplicate would also discard any node the nested HashCons::mk put into the hash set.
+/// Build operands first and pass them in - as in the example above.
+/// Debug builds assert this.
+/// @warning HashCons never runs destructors: All node classes must be trivially destructible.
+template<class B, class Hash = std::hash<B>, class Equal = std::equal_to<B>> class HashCons {
+public:
+    /// @name Construction
+    ///@{
+    HashCons(const HashCons&) = delete;
+#ifdef FE_ABSL
+    HashCons(size_t page_size = Arena::Default_Page_Size) noexcept
+        : nodes_(page_size) {}
+#else
+    HashCons(size_t page_size = Arena::Default_Page_Size) noexcept
+        : nodes_(page_size)
+        , set_(container_.allocator<const B*>()) {}
+#endif
+    HashCons(HashCons&& other) noexcept
+        : HashCons() {
+        swap(*this, other);
+    }
+    HashCons& operator=(HashCons) = delete;
+    ///@}
+
+    /// Yields the unique node that equals `T(args...)`.
+    /// @warning `T(args...)` must not invoke HashCons::mk on `this` - see above.
+    template<class T = B, class... Args> const T* mk(Args&&... args) {
+        static_assert(std::is_base_of_v<B, T>);
+        static_assert(std::is_trivially_destructible_v<T>, "HashCons never runs destructors");
+
+        auto state = nodes_.state();
+        Nesting nesting(depth_);
+        auto node = new (nodes_.allocate<T>(1)) T(std::forward<Args>(args)...);
+        // Not emplace: It may allocate a hash set node before noticing a duplicate - and Arena::Allocator never frees.
+        auto [i, ins] = set_.insert(node);
+        if (!ins) nodes_.deallocate(state);
+        return static_cast<const T*>(*i);
+    }
+
+    /// @name Getters
+    ///@{
+    size_t size() const { return set_.size(); } ///< Number of distinct nodes.
+    /// Allocate variable-length payloads of nodes from here - but only from within the constructor invoked by mk.
+    Arena& arena() { return nodes_; }
+    /// Bytes of all Arena pages that hold the nodes and - unless `FE_ABSL` - the hash set.
+    size_t num_bytes() const {
+#ifdef FE_ABSL
+        return nodes_.num_bytes();
+#else
+        return nodes_.num_bytes() + container_.num_bytes();
+#endif
+    }
+    ///@}
+
+    friend void swap(HashCons& h1, HashCons& h2) noexcept {
+        using std::swap;
+        // clang-format off
+        swap(h1.nodes_,     h2.nodes_    );
+#ifndef FE_ABSL
+        swap(h1.container_, h2.container_);
+#endif
+        swap(h1.set_,       h2.set_      );
+        // clang-format on
+    }
+
+private:
+    struct Nesting {
+        Nesting(size_t& depth)
+            : depth(depth) {
+            assert(depth == 0 && "node constructor must not invoke HashCons::mk on the same HashCons");
+            ++depth;
+        }
+        ~Nesting() { --depth; }
+
+        size_t& depth;
+    };
+
+    struct NodeHash {
+        size_t operator()(const B* node) const { return Hash()(*node); }
+    };
+    struct NodeEqual {
+        bool operator()(const B* n1, const B* n2) const { return Equal()(*n1, *n2); }
+    };
+
+    Arena nodes_;
+#ifdef FE_ABSL
+    absl::flat_hash_set<const B*, NodeHash, NodeEqual> set_;
+#else
+    Arena container_;
+    std::unordered_set<const B*, NodeHash, NodeEqual, Arena::Allocator<const B*>> set_;
+#endif
+    /// Number of HashCons::mk%s currently running a node constructor.
+    /// Also kept in release builds - otherwise, the layout of HashCons would depend on `NDEBUG`.
+    size_t depth_ = 0;
+};
+
+} // namespace fe
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/// @file
+/// Bits of JSON output shared by fe/diag_sinks.h and fe/trace.h.
+/// This header only depends on the standard library, so fe/trace.h can include it without pulling in fe/format.h.
+
+namespace fe::detail::json {
+
+/// Appends @p s as quoted and escaped JSON string to @p out.
+inline void str(std::string& out, std::string_view s) {
+    out += '"';
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (auto u = (unsigned char)c; u < 0x20) {
+                    out += "\\u00";
+                    out += "0123456789abcdef"[u >> 4];
+                    out += "0123456789abcdef"[u & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+} // namespace fe::detail::json
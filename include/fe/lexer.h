@@ -5,6 +5,7 @@
 
 #include "fe/loc.h"
 #include "fe/ring.h"
+#include "fe/trace.h"
 #include "fe/utf8.h"
 
 namespace fe {
@@ -38,6 +39,7 @@ protected:
     /// Get next `char32_t` in Lexer::istream_ and increase Lexer::loc_.
     /// @returns Null on an invalid UTF-8 sequence.
     char32_t next() {
+        FE_TRACE_COUNT(Chars, 1);
         loc_.finis = peek_;
         auto res   = ahead_.put(utf8::decode(istream_));
         auto c     = ahead_.front(); // char of the peek location
@@ -1,3 +1,5 @@
+#include <iostream>
+
 #include "fe/format.h"
 #include "fe/loc.h"
 
@@ -13,7 +15,7 @@ std::ostream& operator<<(std::ostream& os, Pos pos) {
 
 std::ostream& operator<<(std::ostream& os, Loc loc) {
     if (loc) {
-        os << (loc.path ? loc.path->string() : "<unknown file>") << ':' << loc.begin;
+        os << (loc.path ? path2str(*loc.path) : "<unknown file>") << ':' << loc.begin;
         if (loc.begin != loc.finis) os << '-' << loc.finis;
         return os;
     }
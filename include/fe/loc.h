@@ -1,11 +1,33 @@
 #pragma once
 
 #include <filesystem>
+#include <string_view>
+#ifdef _WIN32
+#    include <unordered_map>
+#endif
 
 #include "fe/sym.h"
 
 namespace fe {
 
+/// Yields the display string of @p path.
+/// On POSIX systems, this is just a view onto `path.native()` and does not allocate.
+/// Otherwise, the converted string is cached once per path (per thread).
+inline std::string_view path2str(const std::filesystem::path& path) {
+#ifdef _WIN32
+    struct Entry {
+        std::filesystem::path::string_type native;
+        std::string str;
+    };
+    static thread_local std::unordered_map<const std::filesystem::path*, Entry> cache;
+    auto& entry = cache[&path];
+    if (entry.native != path.native()) entry = {path.native(), path.string()}; // new or reused address
+    return entry.str;
+#else
+    return path.native();
+#endif
+}
+
 /// Pos%ition in a source file; pass around as value.
 struct Pos {
     Pos() = default; ///< Creates an invalid Pos%ition.
@@ -62,4 +84,8 @@ struct Loc {
     friend std::ostream& operator<<(std::ostream& os, Loc loc);
 };
 
+// Pos and Loc are in every token and every AST node: don't let them grow by accident.
+static_assert(sizeof(Pos) == 2 * sizeof(uint16_t));
+static_assert(sizeof(Loc) == sizeof(void*) + 2 * sizeof(Pos));
+
 } // namespace fe
@@ -2,6 +2,7 @@
 
 #include "fe/loc.h"
 #include "fe/ring.h"
+#include "fe/trace.h"
 
 namespace fe {
 
@@ -38,7 +39,11 @@ protected:
     ///@{
     void init(const std::filesystem::path* path) {
         ahead_.reset();
-        for (size_t i = 0; i != K; ++i) ahead_[i] = self().lexer().lex();
+        for (size_t i = 0; i != K; ++i) {
+            FE_TRACE_TIME(Lex_ns);
+            ahead_[i] = self().lexer().lex();
+        }
+        FE_TRACE_COUNT(Tokens, K);
         prev_ = Loc(path, {1, 1});
     }
     ///@}
@@ -80,7 +85,11 @@ protected:
     Tok lex() {
         auto result = ahead();
         prev_       = result.loc();
-        ahead_.put(self().lexer().lex());
+        {
+            FE_TRACE_TIME(Lex_ns);
+            ahead_.put(self().lexer().lex());
+        }
+        FE_TRACE_COUNT(Tokens, 1);
         return result;
     }
 
@@ -2,9 +2,9 @@
 
 #include <cstddef>
 
-#include <algorithm>
 #include <array>
 #include <initializer_list>
+#include <utility>
 
 #include <fe/assert.h>
 
@@ -15,7 +15,10 @@ template<class T, size_t N> class Ring {
 public:
     /// @name Construction
     ///@{
-    Ring(std::initializer_list<T> list) { std::copy(list.begin(), list.end(), array_); }
+    Ring(std::initializer_list<T> list) {
+        size_t i = 0;
+        for (const auto& item : list) array_[i++] = item;
+    }
     Ring() noexcept   = default;
     Ring(const Ring&) = default;
     Ring(Ring&& other) noexcept
@@ -118,7 +121,10 @@ template<class T> class Ring<T, 2> {
 public:
     /// @name Construction
     ///@{
-    Ring(std::initializer_list<T> list) { std::copy(list.begin(), list.end(), array_); }
+    Ring(std::initializer_list<T> list) {
+        size_t i = 0;
+        for (const auto& item : list) array_[i++] = item;
+    }
     Ring() noexcept   = default;
     Ring(const Ring&) = default;
     Ring(Ring&& other) noexcept
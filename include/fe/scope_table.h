@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+
+#include <type_traits>
+#include <vector>
+
+#include "fe/arena.h"
+#include "fe/sym.h"
+
+namespace fe {
+
+/// Maps Sym%bols to their innermost binding of type @p V - usually a pointer to a declaration - in nested scopes.
+/// Instead of a stack of SymMap%s - i.e. a hash map per scope - ScopeTable uses a *shadow stack*:
+/// * one SymMap from each Sym to its innermost binding, which in turn points to the binding it shadows,
+/// * and an undo log per scope: the list of bindings this scope introduced.
+///
+/// Bindings live in an Arena; ScopeTable::pop restores the shadowed bindings and rolls the Arena back.
+/// Hence, ScopeTable::push is O(1) and ScopeTable::pop is O(number of bindings of the scope) - both without any heap
+/// calls once the SymMap has seen all names:
+/// ```
+/// fe::ScopeTable<Decl*> scopes;
+/// scopes.bind(x, outer);
+/// {
+///     auto scope = scopes.scope(); // or scopes.push() ... scopes.pop()
+///     if (!scopes.bind(x, inner)) error("redeclaration of '{}'", x);
+///     assert(scopes.find(x) == inner);
+/// }
+/// assert(scopes.find(x) == outer);
+/// ```
+/// @warning ScopeTable never runs destructors: @p V must be trivially destructible.
+template<class V> class ScopeTable {
+public:
+    static_assert(std::is_trivially_destructible_v<V>, "ScopeTable never runs destructors");
+
+    /// @name Construction
+    ///@{
+    ScopeTable(const ScopeTable&) = delete;
+    ScopeTable(size_t page_size = Arena::Default_Page_Size)
+        : arena_(page_size) {
+        push(); // global scope
+    }
+    ScopeTable(ScopeTable&&)          = default;
+    ScopeTable& operator=(ScopeTable) = delete;
+    ///@}
+
+    /// @name Scopes
+    ///@{
+    /// Number of open scopes except the global one.
+    size_t depth() const { return frames_.size() - 1; }
+    void push() { frames_.push_back({nullptr, arena_.state()}); }
+    /// Removes all bindings of the innermost scope - this makes the bindings they shadow visible again.
+    void pop() {
+        assert(depth() != 0 && "cannot pop global scope");
+        auto [undo, state] = frames_.back();
+        for (auto binding = undo; binding; binding = binding->next) map_[binding->sym] = binding->shadowed;
+        arena_.deallocate(state);
+        frames_.pop_back();
+    }
+
+    /// Invokes ScopeTable::pop upon destruction.
+    class [[nodiscard]] Scope {
+    public:
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { table_.pop(); }
+
+    private:
+        Scope(ScopeTable& table)
+            : table_(table) {
+            table_.push();
+        }
+
+        ScopeTable& table_;
+
+        friend class ScopeTable;
+    };
+
+    /// ScopeTable::push%es a new scope and ScopeTable::pop%s it again when the returned Scope dies.
+    Scope scope() { return Scope(*this); }
+    ///@}
+
+    /// @name Bindings
+    ///@{
+    /// Binds @p sym to @p val in the innermost scope - shadowing any binding of @p sym in outer scopes.
+    /// @returns `false` - and leaves everything as is - if @p sym is already bound in the innermost scope.
+    bool bind(Sym sym, V val) {
+        auto& slot = map_[sym];
+        if (slot && slot->depth == depth()) return false;
+        auto& undo = frames_.back().undo;
+        undo       = new (arena_.allocate<Binding>(1)) Binding{val, sym, slot, undo, depth()};
+        slot       = undo;
+        return true;
+    }
+
+    /// Innermost binding of @p sym or `nullptr`.
+    V* find(Sym sym) {
+        auto i = map_.find(sym);
+        return i != map_.end() && i->second ? &i->second->val : nullptr;
+    }
+    const V* find(Sym sym) const { return const_cast<ScopeTable*>(this)->find(sym); } ///< `const` version.
+
+    /// Binding of @p sym in the innermost scope or `nullptr` - e.g., to point to the previous declaration in
+    /// a "redeclaration" error after ScopeTable::bind failed.
+    V* find_local(Sym sym) {
+        auto i = map_.find(sym);
+        return i != map_.end() && i->second && i->second->depth == depth() ? &i->second->val : nullptr;
+    }
+    ///@}
+
+    /// Bytes of all Arena pages that hold the bindings.
+    size_t num_bytes() const { return arena_.num_bytes(); }
+
+private:
+    struct Binding {
+        V val;
+        Sym sym;
+        Binding* shadowed; ///< Binding of sym in an outer scope or `nullptr`.
+        Binding* next;     ///< Next older Binding of the same scope - the undo log.
+        size_t depth;
+    };
+
+    struct Frame {
+        Binding* undo; ///< Newest Binding of this scope.
+        Arena::State state;
+    };
+
+    Arena arena_;
+    std::vector<Frame> frames_;
+    SymMap<Binding*> map_; ///< Slots of popped bindings stay in here - as `nullptr` - for reuse.
+};
+
+} // namespace fe
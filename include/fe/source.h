@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "fe/loc.h"
+
+namespace fe {
+
+/// The contents of a source file together with an index of where each line begins.
+class Source {
+public:
+    Source(std::string text)
+        : text_(std::move(text)) {
+        size_t begin = text_.starts_with("\xef\xbb\xbf") ? 3 : 0; // skip UTF-8 BOM
+        lines_.emplace_back(begin);
+        for (size_t i = begin, e = text_.size(); i != e; ++i)
+            if (text_[i] == '\n') lines_.emplace_back(i + 1);
+    }
+
+    std::string_view text() const { return text_; }
+    size_t num_lines() const { return lines_.size(); }
+
+    /// Yields line @p row *without* the line break; rows start at `1` - just like in Pos::row.
+    /// @returns the empty `std::string_view` if @p row is out of range.
+    std::string_view line(size_t row) const {
+        if (row == 0 || row > lines_.size()) return {};
+        auto begin = lines_[row - 1];
+        auto end   = row < lines_.size() ? lines_[row] - 1 : text_.size();
+        if (end > begin && text_[end - 1] == '\r') --end;
+        return std::string_view(text_).substr(begin, end - begin);
+    }
+
+    /// Finds the row that contains byte @p offset in O(log n).
+    size_t row(size_t offset) const {
+        size_t lo = 0, hi = lines_.size(); // binary search for the first line that begins after offset
+        while (lo != hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (lines_[mid] <= offset)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+private:
+    std::string text_;
+    std::vector<size_t> lines_; ///< Byte offset of each line.
+};
+
+/// Caches Source%s - keyed by the same `std::filesystem::path` pointers used in Loc::path.
+/// Each file is read at most once: either you SourceCache::add what you already have in memory, or SourceCache::get
+/// will read it from disk upon first request.
+/// SourceCache::add and SourceCache::get are thread-safe - just like Diags, which may call the latter from any thread
+/// that flushes; a file is read without holding the lock.
+class SourceCache {
+public:
+    /// @name Construction
+    ///@{
+    SourceCache() = default;
+    /// @warning Don't move a SourceCache while another thread uses it.
+    SourceCache(SourceCache&& other) noexcept
+        : sources_(std::move(other.sources_)) {}
+    ///@}
+
+    /// Registers @p text as contents of @p path.
+    /// @warning This invalidates what SourceCache::get or SourceCache::add previously returned for @p path.
+    const Source& add(const std::filesystem::path* path, std::string text) {
+        Source source(std::move(text));
+        std::lock_guard lock(mutex_);
+        return *sources_.insert_or_assign(path, std::move(source)).first->second;
+    }
+
+    /// @returns `nullptr` if @p path is `nullptr` or cannot be read; a failure is cached as well.
+    const Source* get(const std::filesystem::path* path) {
+        if (path == nullptr) return nullptr;
+        {
+            std::lock_guard lock(mutex_);
+            if (auto i = sources_.find(path); i != sources_.end()) return i->second ? &*i->second : nullptr;
+        }
+
+        auto text   = read(*path);
+        auto source = text ? std::optional<Source>(std::move(*text)) : std::nullopt;
+        std::lock_guard lock(mutex_);
+        auto& res = sources_.try_emplace(path, std::move(source)).first->second; // another thread may have been faster
+        return res ? &*res : nullptr;
+    }
+
+private:
+    /// Reads the whole file via `<cstdio>` - `<fstream>` would make every Driver user compile all of iostreams.
+    static std::optional<std::string> read(const std::filesystem::path& path) {
+#ifdef _WIN32
+        auto file = _wfopen(path.c_str(), L"rb");
+#else
+        auto file = std::fopen(path.c_str(), "rb");
+#endif
+        if (file == nullptr) return std::nullopt;
+        std::string text;
+        char buf[4096];
+        for (size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) != 0;) text.append(buf, n);
+        bool ok = !std::ferror(file);
+        std::fclose(file);
+        if (!ok) return std::nullopt;
+        return text;
+    }
+
+    std::mutex mutex_; ///< Protects SourceCache::sources_.
+    std::unordered_map<const std::filesystem::path*, std::optional<Source>> sources_;
+};
+
+} // namespace fe
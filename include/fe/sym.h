@@ -4,8 +4,9 @@
 #include <cstring>
 
 #include <bit>
-#include <iostream>
+#include <iosfwd>
 #include <string>
+#include <string_view>
 
 #ifdef FE_ABSL
 #    include <absl/container/flat_hash_map.h>
@@ -16,6 +17,7 @@
 #endif
 
 #include "fe/arena.h"
+#include "fe/trace.h"
 
 static_assert(std::endian::native == std::endian::little || std::endian::native == std::endian::big,
               "mixed endianess not supported");
@@ -93,7 +95,13 @@ public:
     ///@{
     char operator[](size_t i) const {
         assert(i < size());
-        return c_str()[i];
+        // Extract short strings from the register: Going through c_str() would index into ptr_ with an index that
+        // GCC can't bound - and, thus, -Warray-bounds.
+        if (ptr_ & Short_String_Mask) {
+            auto shift = std::endian::native == std::endian::little ? 8 * (i + 1) : 8 * (Short_String_Bytes - 1 - i);
+            return char((ptr_ >> shift) & 0xff);
+        }
+        return ((const String*)ptr_)->chars[i];
     }
     char front() const { return (*this)[0]; }
     char back() const { return (*this)[size() - 1]; }
@@ -155,7 +163,10 @@ public:
     template<class H> friend H AbslHashValue(H h, Sym sym) { return H::combine(std::move(h), sym.ptr_); }
 #endif
     friend struct ::std::hash<fe::Sym>;
-    friend std::ostream& operator<<(std::ostream& o, Sym sym) { return o << sym.view(); }
+    template<class Traits> // avoids `#include <ostream>`
+    friend std::basic_ostream<char, Traits>& operator<<(std::basic_ostream<char, Traits>& os, Sym sym) {
+        return os << sym.view();
+    }
 
 private:
     // Little endian: 2 a b 0 register: 0ba2
@@ -165,6 +176,8 @@ private:
     friend class SymPool;
 };
 
+static_assert(sizeof(Sym) == sizeof(uintptr_t), "Sym is passed around by value in registers");
+
 #ifndef DOXYGEN
 } // namespace fe
 
@@ -213,6 +226,8 @@ public:
     ///@{
     Sym sym(std::string_view s) {
         if (s.empty()) return Sym();
+        FE_TRACE_COUNT(Sym_Lookups, 1);
+        FE_TRACE_TIME(Sym_ns);
         auto size = s.size();
 
         if (size <= Sym::Short_String_Bytes - 2) { // small string: need two more bytes for `\0' and size
@@ -220,10 +235,11 @@ public:
             // Little endian: 2 a b 0 register: 0ba2
             // Big endian:    a b 0 2 register: ab02
             if constexpr (std::endian::native == std::endian::little)
-                for (uintptr_t i = 0, shift = 8; i != size; ++i, shift += 8) ptr |= (uintptr_t(s[i]) << shift);
+                for (uintptr_t i = 0, shift = 8; i != size; ++i, shift += 8)
+                    ptr |= (uintptr_t((unsigned char)s[i]) << shift);
             else
                 for (uintptr_t i = 0, shift = (Sym::Short_String_Bytes - 1) * 8; i != size; ++i, shift -= 8)
-                    ptr |= (uintptr_t(s[i]) << shift);
+                    ptr |= (uintptr_t((unsigned char)s[i]) << shift);
             return Sym(ptr);
         }
 
@@ -231,8 +247,12 @@ public:
         auto ptr   = (String*)strings_.align(Sym::Short_String_Bytes).allocate(sizeof(String) + s.size() + 1 /*'\0'*/);
         new (ptr) String(s.size());
         *std::copy(s.begin(), s.end(), ptr->chars) = '\0';
-        auto [i, ins]                              = pool_.emplace(ptr);
-        if (ins) return Sym((uintptr_t)ptr);
+        // Not emplace: It may allocate a hash set node before noticing a duplicate - and Arena::Allocator never frees.
+        auto [i, ins] = pool_.insert(ptr);
+        if (ins) {
+            FE_TRACE_COUNT(Sym_Interned, 1);
+            return Sym((uintptr_t)ptr);
+        }
         strings_.deallocate(state);
         return Sym((uintptr_t)*i);
     }
@@ -242,6 +262,15 @@ public:
     // TODO we can try to fit s in current page and hence eliminate the explicit use of strlen
     ///@}
 
+    /// Bytes of all Arena pages that hold this SymPool's strings and - unless `FE_ABSL` - its hash set.
+    size_t num_bytes() const {
+#ifdef FE_ABSL
+        return strings_.num_bytes();
+#else
+        return strings_.num_bytes() + container_.num_bytes();
+#endif
+    }
+
     friend void swap(SymPool& p1, SymPool& p2) noexcept {
         using std::swap;
         // clang-format off
@@ -0,0 +1,196 @@
+#pragma once
+
+/// @file
+/// Lightweight tracing of where a frontend spends its time - without an external profiler.
+/// Define `FE_TRACE` (e.g., via the CMake option of the same name) to enable it; otherwise, all `FE_TRACE_*` macros
+/// expand to nothing and this header does not even include anything.
+/// ```
+/// {
+///     FE_TRACE_SCOPE("parse"); // scoped phase timer
+///     parser.parse_prog();
+/// }
+/// FE_TRACE_COUNT(Tokens, 1);   // event counter; see Trace::Counter
+/// FE_TRACE_TIME(Lex_ns);       // adds the time until the end of the scope to a Trace::Counter
+/// fe::Trace::get().write(ofs); // open in chrome://tracing or https://ui.perfetto.dev
+/// ```
+/// FE itself counts Trace::Counter%s in Lexer, Parser, SymPool, Arena, and Driver, and times Diags::flush.
+/// Lexing and interning run interleaved with parsing - token by token - so instead of recording millions of
+/// FE_TRACE_SCOPE%s, Parser and SymPool accumulate their time in the counters `lex_ns` and `sym_ns`;
+/// `lex_ns` includes `sym_ns` for the Sym%bols the Lexer interns.
+/// These two clock reads per token and Sym%bol lookup roughly halve the parser's throughput, so only compare traced
+/// runs with traced runs.
+/// Wrap your parser's entry point in an FE_TRACE_SCOPE for the total; see `Parser::parse_prog` in `tests/let.h`.
+
+#ifdef FE_TRACE
+
+#    include <cstdint>
+
+#    include <array>
+#    include <atomic>
+#    include <chrono>
+#    include <mutex>
+#    include <ostream>
+#    include <string>
+#    include <string_view>
+#    include <vector>
+
+#    include "fe/json.h"
+
+namespace fe {
+
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // clang-format off
+    /// @name Counter
+    ///@{
+#    define FE_TRACE_COUNTER(m)                                      \
+        m(Chars,        "chars")        /* decoded by Lexer       */ \
+        m(Tokens,       "tokens")       /* shifted by Parser      */ \
+        m(Sym_Lookups,  "sym_lookups")  /* SymPool::sym           */ \
+        m(Sym_Interned, "sym_interned") /* new strings in SymPool */ \
+        m(Arena_Bytes,  "arena_bytes")  /* Arena::allocate        */ \
+        m(Arena_Pages,  "arena_pages")  /* new Arena pages        */ \
+        m(Diags,        "diags")        /* issued via Driver      */ \
+        m(Lex_ns,       "lex_ns")       /* Parser invoking lex()  */ \
+        m(Sym_ns,       "sym_ns")       /* in SymPool::sym        */
+    // clang-format on
+
+    enum class Counter {
+#    define CODE(c, str) c,
+        FE_TRACE_COUNTER(CODE)
+#    undef CODE
+    };
+
+    static constexpr size_t Num_Counters = 0
+#    define CODE(c, str) +1
+        FE_TRACE_COUNTER(CODE)
+#    undef CODE
+        ;
+
+    static constexpr std::string_view counter2str(Counter c) {
+        switch (c) {
+#    define CODE(c, str) \
+        case Counter::c: return str;
+            FE_TRACE_COUNTER(CODE)
+#    undef CODE
+            default: return "<unknown counter>";
+        }
+    }
+
+    void count(Counter c, uint64_t n) { counters_[size_t(c)].fetch_add(n, std::memory_order_relaxed); }
+    uint64_t counter(Counter c) const { return counters_[size_t(c)].load(std::memory_order_relaxed); }
+    ///@}
+
+    /// Records the time between construction and destruction as Chrome trace event.
+    class Scope {
+    public:
+        Scope(const char* name)
+            : name_(name)
+            , begin_((get(), Clock::now())) {} // make sure Trace::origin_ comes first
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { get().record(name_, begin_, Clock::now()); }
+
+    private:
+        const char* name_;
+        Clock::time_point begin_;
+    };
+
+    /// Adds the nanoseconds between construction and destruction to a Counter.
+    class Timer {
+    public:
+        Timer(Counter counter)
+            : counter_(counter)
+            , begin_(Clock::now()) {}
+        Timer(const Timer&)            = delete;
+        Timer& operator=(const Timer&) = delete;
+        ~Timer() {
+            get().count(counter_, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin_).count());
+        }
+
+    private:
+        Counter counter_;
+        Clock::time_point begin_;
+    };
+
+    /// The one and only Trace of this process.
+    static Trace& get() {
+        static Trace trace;
+        return trace;
+    }
+
+    /// Writes all recorded Scope%s and the current Counter values as
+    /// [Chrome trace event](https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU) JSON.
+    void write(std::ostream& os) const {
+        std::lock_guard lock(mutex_);
+        // Microseconds as fixed-point number with 3 decimals - streaming a double only yields 6 significant digits.
+        auto us = [&os](Clock::time_point begin, Clock::time_point end) -> std::ostream& {
+            auto ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            char frac[] = {'.', char('0' + ns / 100 % 10), char('0' + ns / 10 % 10), char('0' + ns % 10), '\0'};
+            return os << ns / 1000 << frac;
+        };
+
+        os << "{\"traceEvents\":[\n";
+        std::string name;
+        for (const auto& e : events_) {
+            name.clear();
+            detail::json::str(name, e.name);
+            os << "{\"name\":" << name << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid << ",\"ts\":";
+            us(origin_, e.begin) << ",\"dur\":";
+            us(e.begin, e.end) << "},\n";
+        }
+        os << "{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":";
+        us(origin_, Clock::now()) << ",\"args\":{";
+        for (size_t i = 0; i != Num_Counters; ++i)
+            os << (i ? "," : "") << '"' << counter2str(Counter(i)) << "\":" << counter(Counter(i));
+        os << "}}\n]}\n";
+    }
+
+    /// Discards all recorded Scope%s and resets all Counter%s.
+    void clear() {
+        std::lock_guard lock(mutex_);
+        events_.clear();
+        for (auto& counter : counters_) counter = 0;
+    }
+
+private:
+    struct Event {
+        const char* name;
+        size_t tid;
+        Clock::time_point begin, end;
+    };
+
+    Trace()
+        : origin_(Clock::now()) {}
+
+    void record(const char* name, Clock::time_point begin, Clock::time_point end) {
+        static std::atomic<size_t> next_tid = 0;
+        static thread_local size_t tid      = next_tid++;
+        std::lock_guard lock(mutex_);
+        events_.emplace_back(name, tid, begin, end);
+    }
+
+    Clock::time_point origin_;
+    std::array<std::atomic<uint64_t>, Num_Counters> counters_ = {};
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+};
+
+} // namespace fe
+
+#    define FE_TRACE_CONCAT_(a, b) a##b
+#    define FE_TRACE_CONCAT(a, b)  FE_TRACE_CONCAT_(a, b)
+#    define FE_TRACE_SCOPE(name)   ::fe::Trace::Scope FE_TRACE_CONCAT(fe_trace_scope_, __LINE__)(name)
+#    define FE_TRACE_COUNT(c, n)   ::fe::Trace::get().count(::fe::Trace::Counter::c, (n))
+#    define FE_TRACE_TIME(c) \
+        ::fe::Trace::Timer FE_TRACE_CONCAT(fe_trace_timer_, __LINE__)(::fe::Trace::Counter::c)
+
+#else
+
+#    define FE_TRACE_SCOPE(name) ((void)0)
+#    define FE_TRACE_COUNT(c, n) ((void)0)
+#    define FE_TRACE_TIME(c)     ((void)0)
+
+#endif
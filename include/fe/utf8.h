@@ -1,18 +1,18 @@
 #pragma once
 
 #include <cctype>
+#include <cstdio>
 
-#include <istream>
-#include <ostream>
+#include <iosfwd>
 
 #include "fe/assert.h"
 
 namespace fe::utf8 {
 
-static constexpr size_t Max    = 4;      ///< Maximal number of `char8_t`s of an UTF-8 byte sequence.
-static constexpr char32_t BOM  = 0xfeff; ///< [Byte Order Mark](https://en.wikipedia.org/wiki/Byte_order_mark#UTF-8).
-static constexpr char32_t EoF  = (char32_t)std::istream::traits_type::eof(); ///< End of File.
-static constexpr char32_t Null = 0;
+inline constexpr size_t Max    = 4;      ///< Maximal number of `char8_t`s of an UTF-8 byte sequence.
+inline constexpr char32_t BOM  = 0xfeff; ///< [Byte Order Mark](https://en.wikipedia.org/wiki/Byte_order_mark#UTF-8).
+inline constexpr char32_t EoF  = (char32_t)EOF; ///< End of File; same as `std::istream::traits_type::eof()`.
+inline constexpr char32_t Null = 0;
 
 /// Returns the expected number of bytes for an UTF-8 char sequence by inspecting the first byte.
 /// Retuns @c 0 if invalid.
@@ -38,7 +38,8 @@ inline char8_t is_valid234(char8_t c) {
 
 /// Decodes the next sequence of bytes from @p is as UTF-32.
 /// @returns Null on error.
-inline char32_t decode(std::istream& is) {
+/// Templated to avoid `#include <istream>` here; just pass an `std::istream`.
+template<class Traits> char32_t decode(std::basic_istream<char, Traits>& is) {
     char32_t result = is.get();
     if (result == EoF) return result;
 
@@ -55,33 +56,38 @@ inline char32_t decode(std::istream& is) {
                     return 0;
     }
 
-    return result;
+    return result <= 0x10ffff ? result : Null; // 4-byte sequences can encode up to 0x1fffff
 }
 
-namespace {
-// and, or
-std::ostream& ao(std::ostream& os, char32_t c32, char32_t a = 0b00111111, char32_t o = 0b10000000) {
-    return os << char((c32 & a) | o);
+/// Encodes the UTF-32 char @p c32 as UTF-8 into @p buf which must provide room for at least utf8::Max bytes.
+/// @returns the number of bytes written or `0` on error.
+inline size_t encode(char* buf, char32_t c32) {
+    // and, or
+    auto ao = [](char32_t c, char32_t a = 0b00111111, char32_t o = 0b10000000) { return char((c & a) | o); };
+    // clang-format off
+    if (c32 <= 0x00007f) { buf[0] = ao(c32      , 0b11111111, 0b00000000);                                                     return 1; }
+    if (c32 <= 0x0007ff) { buf[0] = ao(c32 >>  6, 0b00011111, 0b11000000);                                  buf[1] = ao(c32); return 2; }
+    if (c32 <= 0x00ffff) { buf[0] = ao(c32 >> 12, 0b00001111, 0b11100000);            buf[1] = ao(c32 >> 6); buf[2] = ao(c32); return 3; }
+    if (c32 <= 0x10ffff) { buf[0] = ao(c32 >> 18, 0b00000111, 0b11110000); buf[1] = ao(c32 >> 12); buf[2] = ao(c32 >> 6); buf[3] = ao(c32); return 4; }
+    // clang-format on
+    return 0;
 }
-} // namespace
 
 /// Encodes the UTF-32 char @p c32 as UTF-8 and writes the sequence of bytes to @p os.
 /// @returns `false` on error.
-inline bool encode(std::ostream& os, char32_t c32) {
-    // clang-format off
-    if (c32 <= 0x00007f) {          ao(os, c32      , 0b11111111, 0b00000000);                              return true; }
-    if (c32 <= 0x0007ff) {       ao(ao(os, c32 >>  6, 0b00011111, 0b11000000),                        c32); return true; }
-    if (c32 <= 0x00ffff) {    ao(ao(ao(os, c32 >> 12, 0b00001111, 0b11100000),             c32 >> 6), c32); return true; }
-    if (c32 <= 0x10ffff) { ao(ao(ao(ao(os, c32 >> 18, 0b00000111, 0b11110000), c32 >> 12), c32 >> 6), c32); return true; }
-    // clang-format on
-    return false;
+template<class Traits> bool encode(std::basic_ostream<char, Traits>& os, char32_t c32) {
+    char buf[Max];
+    auto n = encode(buf, c32);
+    os.write(buf, n);
+    return n != 0;
 }
 /// Wrapper for `char32_t` which has a friend ostream operator.
 struct Char32 {
     Char32(char32_t c)
         : c(c) {}
 
-    friend std::ostream& operator<<(std::ostream& os, Char32 c) {
+    template<class Traits>
+    friend std::basic_ostream<char, Traits>& operator<<(std::basic_ostream<char, Traits>& os, Char32 c) {
         auto res = utf8::encode(os, c.c);
         assert_unused(res);
         return os;
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "fe/format_core.h"
+
+namespace fe {
+
+/// Buffered output for code generators and pretty printers.
+/// Everything is formatted straight into one large buffer which is only written to the underlying `std::ostream`
+/// when it is full or upon Writer::flush - instead of one `std::endl` per line as in fe::outln.
+/// Use like this:
+/// ```
+/// fe::Writer w(std::cout);
+/// fe::Tab tab;
+/// w.outln("{}fn {}() {{", tab++, name);
+/// w.indent(tab).outln("return {};", 23);
+/// w.outln("{}}}", --tab);
+/// w.flush(); // otherwise, happens automatically upon destruction
+/// ```
+/// Without an `std::ostream`, the Writer just accumulates everything in memory; see Writer::view.
+class Writer {
+public:
+    static constexpr size_t Default_Buffer_Size = 1024 * 1024; ///< 1MB.
+
+    /// @name Construction/Destruction
+    ///@{
+    Writer(std::ostream& os, size_t buffer_size = Default_Buffer_Size)
+        : os_(&os)
+        , buffer_size_(buffer_size) {
+        buf_.reserve(buffer_size);
+    }
+    Writer() = default; ///< Writes to memory only.
+    Writer(const Writer&) = delete;
+    Writer(Writer&& other) noexcept
+        : Writer() {
+        swap(*this, other);
+    }
+    Writer& operator=(Writer) = delete;
+    ~Writer() { flush(); }
+    ///@}
+
+    /// @name Output
+    ///@{
+    template<class... Args> Writer& out(format::format_string<Args...> fmt, Args&&... args) {
+        format::format_to(std::back_inserter(buf_), fmt, std::forward<Args&&>(args)...);
+        return drain_if_full();
+    }
+    template<class... Args> Writer& outln(format::format_string<Args...> fmt, Args&&... args) {
+        format::format_to(std::back_inserter(buf_), fmt, std::forward<Args&&>(args)...);
+        buf_ += '\n';
+        return drain_if_full();
+    }
+    Writer& write(std::string_view s) { return buf_.append(s), drain_if_full(); }
+    Writer& write(char c) { return buf_ += c, drain_if_full(); }
+    Writer& indent(Tab tab) { return write(tab.str()); } ///< Writes the whole indentation in one go.
+    ///@}
+
+    /// @name Flush
+    ///@{
+    /// Writes the buffer to the `std::ostream` and flushes it; nop for in-memory Writer%s.
+    void flush() {
+        if (os_ == nullptr) return;
+        drain();
+        os_->flush();
+    }
+
+    /// What has been written but not yet handed to the `std::ostream`; everything for in-memory Writer%s.
+    std::string_view view() const { return buf_; }
+    /// Discards all buffered output.
+    void clear() { buf_.clear(); }
+    ///@}
+
+    friend void swap(Writer& w1, Writer& w2) noexcept {
+        using std::swap;
+        // clang-format off
+        swap(w1.os_,          w2.os_         );
+        swap(w1.buffer_size_, w2.buffer_size_);
+        swap(w1.buf_,         w2.buf_        );
+        // clang-format on
+    }
+
+private:
+    Writer& drain_if_full() {
+        if (os_ != nullptr && buf_.size() >= buffer_size_) drain();
+        return *this;
+    }
+
+    void drain() {
+        os_->write(buf_.data(), buf_.size());
+        buf_.clear();
+    }
+
+    std::ostream* os_   = nullptr;
+    size_t buffer_size_ = 0;
+    std::string buf_;
+};
+
+} // namespace fe
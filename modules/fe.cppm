@@ -0,0 +1,150 @@
+// The fe-module target builds this with -DFE_MODULE=ON - see docs/README.md.
+module;
+
+// All of FE - and thus the standard library and fmt - lives in the global module fragment.
+// The module purview below merely exports FE's names; this is the same approach libc++ uses for `import std;`.
+#include <fe/fe.h>
+#include <fe/loc.cpp.h> // the module library provides Pos/Loc::dump and their ostream operators
+
+export module fe;
+
+// Make sure these explicit specializations are decl-reachable and hence, not discarded with the global module fragment.
+static_assert(sizeof(fe::format::formatter<fe::Pos>) != 0);
+static_assert(sizeof(fe::format::formatter<fe::Loc>) != 0);
+static_assert(sizeof(fe::format::formatter<fe::Sym>) != 0);
+static_assert(sizeof(fe::format::formatter<fe::Tab>) != 0);
+static_assert(sizeof(fe::format::formatter<fe::utf8::Char32>) != 0);
+static_assert(sizeof(std::hash<fe::Sym>) != 0);
+
+export namespace fe {
+// arena.h
+using fe::Arena;
+
+// assert.h
+using fe::breakpoint;
+using fe::unreachable;
+
+// ast.h
+using fe::AST;
+using fe::ASTNode;
+
+// cast.h
+using fe::Kindable;
+using fe::KindRange;
+using fe::Kinds;
+using fe::Nodeable;
+using fe::overloaded;
+using fe::RuntimeCast;
+using fe::visit;
+
+// diag.h
+using fe::DeferredDiags;
+using fe::Diag;
+using fe::Diags;
+using fe::DiagSink;
+using fe::is_lazy;
+using fe::is_lazy_v;
+using fe::TextSink;
+
+// diag_sinks.h
+using fe::JsonSink;
+using fe::SarifSink;
+
+// driver.h
+using fe::Driver;
+
+// enum.h
+using fe::BitEnum;
+using fe::is_bit_enum;
+using fe::is_bit_enum_v;
+using fe::operator&;
+using fe::operator|;
+using fe::operator^;
+using fe::operator<=>;
+using fe::operator==;
+using fe::operator!=;
+
+// format.h, format_core.h
+using fe::basic_ostream_formatter;
+using fe::direct_formatter;
+using fe::err;
+using fe::errln;
+using fe::ostream_formatter;
+using fe::out;
+using fe::outln;
+using fe::Tab;
+
+// fragments.h
+using fe::Fragments;
+
+// hash_cons.h
+using fe::HashCons;
+
+// lexer.h, parser.h, ring.h, scope_table.h
+using fe::Lexer;
+using fe::Parser;
+using fe::Ring;
+using fe::ScopeTable;
+
+// loc.h
+using fe::Loc;
+using fe::path2str;
+using fe::Pos;
+
+// source.h
+using fe::Source;
+using fe::SourceCache;
+
+// sym.h
+using fe::Sym;
+using fe::SymMap;
+using fe::SymPool;
+using fe::SymSet;
+
+// writer.h
+using fe::Writer;
+
+namespace format {
+using fe::format::format;
+using fe::format::format_string;
+using fe::format::format_to;
+using fe::format::formatted_size;
+using fe::format::formatter;
+using fe::format::make_format_args;
+using fe::format::vformat;
+using fe::format::vformat_to;
+} // namespace format
+
+namespace utf8 {
+using fe::utf8::any;
+using fe::utf8::append;
+using fe::utf8::BOM;
+using fe::utf8::Char32;
+using fe::utf8::decode;
+using fe::utf8::encode;
+using fe::utf8::EoF;
+using fe::utf8::first;
+using fe::utf8::is_valid234;
+using fe::utf8::isalnum;
+using fe::utf8::isalpha;
+using fe::utf8::isascii;
+using fe::utf8::isbdigit;
+using fe::utf8::isblank;
+using fe::utf8::iscntrl;
+using fe::utf8::isdigit;
+using fe::utf8::isgraph;
+using fe::utf8::islower;
+using fe::utf8::isodigit;
+using fe::utf8::isprint;
+using fe::utf8::ispunct;
+using fe::utf8::isrange;
+using fe::utf8::isspace;
+using fe::utf8::isupper;
+using fe::utf8::isxdigit;
+using fe::utf8::Max;
+using fe::utf8::Null;
+using fe::utf8::num_bytes;
+using fe::utf8::tolower;
+using fe::utf8::toupper;
+} // namespace utf8
+} // namespace fe
@@ -0,0 +1,88 @@
+#include <doctest/doctest.h>
+#include <fe/ast.h>
+
+namespace {
+
+class Expr;
+class BinExpr;
+class AddExpr;
+class MulExpr;
+class LitExpr;
+class IdExpr;
+
+class Expr : public fe::ASTNode<Expr> {
+public:
+    using Kinds = fe::Kinds<Expr, fe::Kinds<BinExpr, AddExpr, MulExpr>, LitExpr, IdExpr>;
+};
+
+class BinExpr : public Expr {
+public:
+    Expr* lhs() const { return op(0); }
+    Expr* rhs() const { return op(1); }
+};
+
+class AddExpr : public BinExpr {};
+class MulExpr : public BinExpr {};
+
+class LitExpr : public Expr {
+public:
+    LitExpr(uint64_t val)
+        : val(val) {}
+
+    uint64_t val;
+};
+
+class IdExpr : public Expr {
+public:
+    IdExpr(fe::Sym sym)
+        : sym(sym) {}
+
+    fe::Sym sym;
+};
+
+uint64_t eval(const Expr* e) {
+    return fe::visit(
+        *e, [](const AddExpr& a) { return eval(a.lhs()) + eval(a.rhs()); },
+        [](const MulExpr& m) { return eval(m.lhs()) * eval(m.rhs()); }, [](const LitExpr& l) { return l.val; },
+        [](const Expr&) { return uint64_t(0); });
+}
+
+} // namespace
+
+TEST_CASE("AST") {
+    fe::SymPool syms;
+    fe::AST<Expr> ast;
+    fe::Loc loc({1, 1}, {1, 9});
+
+    // (2 + 3) * x
+    auto two = ast.mk<LitExpr>(loc, {}, 2);
+    auto add = ast.mk<AddExpr>(loc, {two, ast.mk<LitExpr>(loc, {}, 3)});
+    auto x   = ast.mk<IdExpr>(loc, {}, syms.sym("x"));
+    auto mul = ast.mk<MulExpr>(loc, {add, x});
+
+    CHECK(mul->kind() == Expr::Kinds::kind<MulExpr>);
+    CHECK(mul->loc() == loc);
+    CHECK(mul->parent() == nullptr);
+    CHECK(mul->num_ops() == 2);
+    CHECK(mul->lhs() == add);
+    CHECK(mul->rhs() == x);
+    CHECK(add->parent() == mul);
+    CHECK(two->parent() == add);
+    CHECK(two->num_ops() == 0);
+    CHECK(two->ops().empty());
+    CHECK(x->sym == syms.sym("x"));
+
+    CHECK(mul->isa<BinExpr>() == mul);
+    CHECK(mul->isa<AddExpr>() == nullptr);
+    CHECK(add->lhs()->isa<LitExpr>() == two);
+    CHECK(eval(add) == 5);
+
+    // operands follow their node in the Arena
+    CHECK((const char*)mul->ops().data() >= (const char*)(mul + 1));
+    CHECK((const char*)mul->ops().data() < (const char*)(mul + 1) + alignof(Expr*));
+
+    // a deep chain fits into one page
+    Expr* e = ast.mk<LitExpr>(loc, {}, 0);
+    for (int i = 0; i != 10000; ++i) e = ast.mk<AddExpr>(loc, {e, nullptr});
+    CHECK(ast.arena().num_pages() == 1);
+}
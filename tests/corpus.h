@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <fe/writer.h>
+
+/// @file
+/// Generates syntactically valid Let programs (see let.h) of arbitrary size - e.g. for benchmarks and fuzzing.
+/// The output only depends on the Corpus::Config: Same Config::seed, same bytes - on every platform.
+
+/// [SplitMix64](https://prng.di.unimi.it/splitmix64.c): tiny, fast, and - unlike `std::uniform_int_distribution` -
+/// portable.
+class SplitMix64 {
+public:
+    SplitMix64(uint64_t seed)
+        : state_(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15);
+        z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    /// Uniformly distributed in `[min, max]`.
+    uint64_t operator()(uint64_t min, uint64_t max) { return min + (*this)() % (max - min + 1); }
+    /// `true` with probability @p p.
+    bool chance(double p) { return double((*this)() >> 11) * 0x1.0p-53 < p; }
+
+private:
+    uint64_t state_;
+};
+
+class Corpus {
+public:
+    struct Config {
+        uint64_t seed   = 0;
+        uint64_t size   = 1024 * 1024; ///< Stop after the statement that exceeds this many bytes.
+        size_t id_min   = 1;           ///< Identifier lengths are uniformly distributed in `[id_min, id_max]`.
+        size_t id_max   = 12;          ///< See above.
+        size_t vocab    = 1024;        ///< Number of distinct identifiers - fewer if `[id_min, id_max]` is too narrow.
+        size_t depth    = 4;           ///< Maximum nesting depth of expressions.
+        double unicode  = 0.;          ///< Probability of a `«»`-quoted subexpression or non-ASCII comment char.
+        double comments = 0.;          ///< Probability of a statement being followed by a `//` comment.
+    };
+
+    Corpus(Config config)
+        : config_(config)
+        , rng_(config.seed) {
+        assert(0 < config.id_min && config.id_min <= config.id_max && "identifier lengths must be in [1, id_max]");
+        assert(config.vocab > 0 && "need at least one identifier");
+        std::unordered_set<std::string> seen;
+        for (size_t tries = 0; vocab_.size() < config.vocab && tries != 64 * config.vocab; ++tries)
+            if (auto s = id(); seen.emplace(s).second) vocab_.emplace_back(std::move(s));
+    }
+
+    /// @returns the number of bytes written.
+    uint64_t generate(fe::Writer& w) {
+        uint64_t size = 0;
+        while (size < config_.size) {
+            buf_.clear();
+            stmt();
+            w.write(buf_);
+            size += buf_.size();
+        }
+        return size;
+    }
+
+    std::string str() {
+        fe::Writer w;
+        generate(w);
+        return std::string(w.view());
+    }
+
+    const std::vector<std::string>& vocab() const { return vocab_; } ///< All distinct identifiers.
+
+private:
+    std::string id() {
+        static constexpr std::string_view Alpha = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+        static constexpr std::string_view Alnum = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+        auto len = rng_(config_.id_min, config_.id_max);
+        std::string res(1, Alpha[rng_() % Alpha.size()]);
+        while (res.size() < len) res += Alnum[rng_() % Alnum.size()];
+        if (res == "let" || res == "return") res += '_';
+        return res;
+    }
+
+    void stmt() {
+        if (rng_.chance(.1)) {
+            buf_ += "return ";
+        } else {
+            buf_ += "let ";
+            buf_ += vocab_[rng_() % vocab_.size()];
+            buf_ += " = ";
+        }
+        expr(config_.depth);
+        buf_ += ';';
+        if (rng_.chance(config_.comments)) comment();
+        buf_ += '\n';
+    }
+
+    void expr(size_t depth) {
+        if (depth == 0 || rng_.chance(.4)) return prim();
+
+        static constexpr std::string_view Ops[] = {" + ", " - ", " * ", " / "};
+        expr(depth - 1);
+        buf_ += Ops[rng_() % std::size(Ops)];
+        if (rng_.chance(config_.unicode)) {
+            buf_ += "«";
+            expr(depth - 1);
+            buf_ += "»";
+        } else if (rng_.chance(.3)) {
+            buf_ += '(';
+            expr(depth - 1);
+            buf_ += ')';
+        } else {
+            expr(depth - 1);
+        }
+    }
+
+    void prim() {
+        if (rng_.chance(.3))
+            buf_ += std::to_string(rng_(0, 100'000));
+        else
+            buf_ += vocab_[rng_() % vocab_.size()];
+    }
+
+    void comment() {
+        static constexpr std::string_view Unicode[] = {"λ", "ä", "€", "→", "𝄞"};
+        buf_ += " //";
+        for (auto i = rng_(0, 40); i-- != 0;) {
+            if (rng_.chance(config_.unicode))
+                buf_ += Unicode[rng_() % std::size(Unicode)];
+            else
+                buf_ += char(rng_(' ', '~'));
+        }
+    }
+
+    Config config_;
+    SplitMix64 rng_;
+    std::vector<std::string> vocab_;
+    std::string buf_; ///< Current statement.
+};
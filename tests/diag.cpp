@@ -0,0 +1,494 @@
+#include <cstdio>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <doctest/doctest.h>
+#include <fe/diag_sinks.h>
+#include <fe/driver.h>
+#include <fe/format.h>
+
+using fe::Loc;
+using fe::Pos;
+using Sev = fe::Diag::Sev;
+
+TEST_CASE("Diags") {
+    std::ostringstream os;
+    const std::filesystem::path a = "a.let", b = "b.let";
+    fe::Driver drv;
+    drv.diags().sink(os).sort(true).batch(0);
+
+    drv.warn(Loc(&b, {1, 1}), "{} {}", "unused", 23);
+    drv.err(Loc(&a, {2, 3}, {2, 5}), "error in a");
+    drv.note(Loc(&a, {1, 1}), "first declared here");
+    drv.err(Loc(&a, {1, 7}), "first error in a");
+    CHECK(os.str().empty());
+    CHECK(drv.diags().num_pending() == 4);
+    CHECK(drv.num_errors() == 2);
+    CHECK(drv.num_warnings() == 1);
+
+    drv.flush();
+    CHECK(drv.diags().num_pending() == 0);
+    CHECK(os.str()
+          == "a.let:1:7: error: first error in a\n"
+             "a.let:2:3-2:5: error: error in a\n"
+             "a.let:1:1: note: first declared here\n"
+             "b.let:1:1: warning: unused 23\n");
+
+    os.str({});
+    drv.diags().sort(false).batch(2);
+    drv.err(Loc(&b, {3, 1}), "x");
+    drv.note(Loc(&b, {3, 1}), "z");
+    drv.err(Loc(&a, {3, 1}), "y");
+    CHECK(os.str().empty());
+    drv.err(Loc(&a, {4, 1}), "w"); // no more notes for y: triggers flush of both including the note
+    CHECK(os.str() == "b.let:3:1: error: x\nb.let:3:1: note: z\na.let:3:1: error: y\n");
+    CHECK(drv.diags().num_pending() == 1);
+}
+
+TEST_CASE("Diags default") {
+    std::ostringstream os;
+    const std::filesystem::path a = "a.let";
+    fe::Driver drv;
+    drv.diags().sink(os);
+
+    CHECK(drv.diags().immediate());
+    drv.err(Loc(&a, {1, 1}), "error");
+    CHECK(os.str() == "a.let:1:1: error: error\n");
+    drv.note(Loc(&a, {1, 2}), "note");
+    CHECK(os.str() == "a.let:1:1: error: error\na.let:1:2: note: note\n");
+    CHECK(drv.diags().num_pending() == 0);
+}
+
+TEST_CASE("Diags batch") {
+    std::ostringstream os;
+    const std::filesystem::path a = "a.let";
+    fe::Driver drv;
+    drv.diags().sink(os).batch(64);
+
+    CHECK(!drv.diags().immediate());
+    for (size_t i = 0; i != 64; ++i) drv.err(Loc(&a, {uint16_t(i + 1), 1}), "error");
+    drv.note(Loc(&a, {1, 2}), "note");
+    CHECK(os.str().empty()); // a full batch - but more notes might come
+    drv.warn(Loc(&a, {100, 1}), "warning");
+    CHECK(os.str().starts_with("a.let:1:1: error: error\n")); // no explicit flush
+    CHECK(os.str().ends_with("a.let:64:1: error: error\na.let:1:2: note: note\n"));
+    CHECK(drv.diags().num_pending() == 1);
+    drv.flush();
+    CHECK(os.str().ends_with("a.let:1:2: note: note\na.let:100:1: warning: warning\n"));
+
+    drv.diags().immediate(true);
+    drv.err(Loc(&a, {101, 1}), "error");
+    CHECK(os.str().ends_with("a.let:100:1: warning: warning\na.let:101:1: error: error\n"));
+}
+
+TEST_CASE("Diags default JSON") {
+    const std::filesystem::path a = "a.let";
+    std::ostringstream os;
+    fe::Driver drv;
+    drv.diags().sink(std::make_unique<fe::JsonSink>(os)).batch(1);
+
+    drv.err("E1", Loc(&a, {1, 1}), "first");
+    drv.note(Loc(&a, {1, 2}), "note");
+    drv.err("E2", Loc(&a, {2, 1}), "second");
+    CHECK(os.str()
+          == R"({"severity":"error","code":"E1","file":"a.let","begin":[1,1],"finis":[1,1],"message":"first",)"
+             R"("notes":[{"severity":"note","file":"a.let","begin":[1,2],"finis":[1,2],"message":"note"}]})"
+             "\n");
+}
+
+TEST_CASE("Driver move") {
+    static_assert(std::is_move_constructible_v<fe::Driver>);
+    const std::filesystem::path a = "a.let";
+    std::ostringstream os;
+    fe::Driver drv;
+    drv.diags().sink(os).batch(0);
+    auto sym = drv.sym("a_long_identifier");
+    drv.err(Loc(&a, {1, 1}), "error");
+    drv.warn(Loc(&a, {2, 1}), "warning");
+
+    auto moved = std::move(drv);
+    CHECK(moved.num_errors() == 1);
+    CHECK(moved.num_warnings() == 1);
+    CHECK(moved.diags().num_pending() == 2);
+    CHECK(moved.sym("a_long_identifier") == sym);
+    moved.flush();
+    CHECK(os.str() == "a.let:1:1: error: error\na.let:2:1: warning: warning\n");
+}
+
+TEST_CASE("Diags std::cerr") {
+    const std::filesystem::path a = "a.let";
+    std::ostringstream os;
+    auto buf = std::cerr.rdbuf(os.rdbuf());
+    {
+        fe::Driver drv;
+        drv.err(Loc(&a, {1, 1}), "error");
+        fe::errln("{}", 42);
+    }
+    std::cerr.rdbuf(buf);
+    CHECK(os.str() == "a.let:1:1: error: error\n42\n"); // in order - nothing is held back
+}
+
+TEST_CASE("Diags FILE") {
+    const std::filesystem::path a = "a.let";
+    auto file                     = std::tmpfile();
+    REQUIRE(file != nullptr);
+    {
+        fe::Driver drv;
+        drv.diags().sink(file);
+        drv.err(Loc(&a, {1, 1}), "error");
+    }
+    std::rewind(file);
+    char buf[64] = {};
+    CHECK(std::string_view(buf, std::fread(buf, 1, sizeof(buf), file)) == "a.let:1:1: error: error\n");
+    std::fclose(file);
+}
+
+TEST_CASE("DiagSink") {
+    const std::filesystem::path a = "a.let";
+    std::ostringstream json, sarif;
+    {
+        fe::Driver drv;
+        drv.diags().sink(std::make_unique<fe::JsonSink>(json)).batch(0);
+        drv.err("E1", Loc(&a, {1, 2}, {1, 5}), "say \"{}\"", "hi");
+        drv.note(Loc(&a, {1, 1}), "here");
+        drv.flush();
+        CHECK(json.str()
+              == R"({"severity":"error","code":"E1","file":"a.let","begin":[1,2],"finis":[1,5],"message":"say \"hi\"",)"
+                 R"("notes":[{"severity":"note","file":"a.let","begin":[1,1],"finis":[1,1],"message":"here"}]})"
+                 "\n");
+
+        drv.diags().sink(std::make_unique<fe::SarifSink>(sarif, "let"));
+        drv.warn("W1", Loc(&a, {2, 3}), "w");
+        drv.err(Loc(&a, {3, 1}), "no code");
+    }
+    CHECK(sarif.str()
+          == R"({"version":"2.1.0","$schema":"https://json.schemastore.org/sarif-2.1.0.json",)"
+             R"("runs":[{"tool":{"driver":{"name":"let"}},"results":[{"ruleId":"W1","level":"warning",)"
+             R"("message":{"text":"w"},"locations":[{"physicalLocation":{"artifactLocation":{"uri":"a.let"},)"
+             R"("region":{"startLine":2,"startColumn":3,"endLine":2,"endColumn":4}}}],"relatedLocations":[]},)"
+             R"({"level":"error","message":{"text":"no code"},"locations":[{"physicalLocation":{"artifactLocation":)"
+             R"({"uri":"a.let"},"region":{"startLine":3,"startColumn":1,"endLine":3,"endColumn":2}}}],)"
+             R"("relatedLocations":[]}]}]})"
+             "\n");
+}
+
+TEST_CASE("SarifSink::uri") {
+    auto uri = [](const std::filesystem::path& path) {
+        std::string res;
+        fe::SarifSink::uri(res, path);
+        return res;
+    };
+    CHECK(uri("a.let") == "a.let");
+    CHECK(uri("sub dir/50%.let") == "sub%20dir/50%25.let");
+    CHECK(uri("c:d.let") == "c%3Ad.let"); // not a scheme
+    CHECK(uri(std::filesystem::path(u8"\u00e4.let")) == "%C3%A4.let");
+#ifdef _WIN32
+    CHECK(uri("C:\\src\\a.let") == "file:///C:/src/a.let");
+#else
+    CHECK(uri("/src/a.let") == "file:///src/a.let");
+#endif
+}
+
+/// Counts how often it is formatted.
+struct Spy {
+    int* n;
+};
+
+template<> struct fe::format::formatter<Spy> : fe::format::formatter<int> {
+    template<class Ctx> auto format(Spy spy, Ctx& ctx) const { return fe::format::formatter<int>::format(++*spy.n, ctx); }
+};
+
+TEST_CASE("Diags filter") {
+    std::ostringstream os;
+    int n = 0;
+    fe::Driver drv;
+    drv.diags().sink(os).suppress("W1").max_errors(2);
+
+    drv.warn("W1", Loc(Pos(1)), "{}", Spy{&n});
+    drv.note(Loc(Pos(1)), "{}", Spy{&n}); // belongs to suppressed warning
+    drv.warn("W2", Loc(Pos(2)), "{}", Spy{&n});
+    drv.err(Loc(Pos(3)), "{}", Spy{&n});
+    drv.err(Loc(Pos(4)), "{}", Spy{&n});
+    drv.err(Loc(Pos(5)), "{}", Spy{&n});
+    CHECK(n == 3);
+    CHECK(drv.num_warnings() == 1);
+    CHECK(drv.num_errors() == 2); // the third one is dropped
+    CHECK(drv.diags().num_dropped() == 2);
+
+    drv.diags().min_sev(fe::Diag::Sev::Err);
+    drv.warn(Loc(Pos(6)), "{}", Spy{&n});
+    CHECK(n == 3);
+    drv.flush();
+    CHECK(os.str() == "<unknown file>:2: warning: 1\n<unknown file>:3: error: 2\n<unknown file>:4: error: 3\n");
+}
+
+TEST_CASE("Diags::Local") {
+    const std::filesystem::path a = "a.let", b = "b.let";
+    auto work = [&](fe::Driver& drv, const std::filesystem::path* path) {
+        for (uint16_t i = 1; i != 100; ++i) {
+            drv.err(Loc(path, {uint16_t(100 - i), 1}), "{} {}", path->string(), i);
+            drv.note(Loc(path, {i, 2}), "note {}", i);
+            if (i % 3 == 0) drv.warn(Loc(path, {i, 3}), "warning {}", i);
+        }
+    };
+
+    std::ostringstream serial, parallel;
+    {
+        fe::Driver drv;
+        drv.diags().sink(serial).sort(true).batch(0);
+        work(drv, &a);
+        work(drv, &b);
+    }
+    {
+        fe::Driver drv;
+        drv.diags().sink(parallel).sort(true).batch(0);
+        std::vector<std::thread> workers;
+        for (auto path : {&b, &a})
+            workers.emplace_back([&, path] {
+                fe::Diags::Local local(drv.diags());
+                work(drv, path);
+            });
+        for (auto& worker : workers) worker.join();
+        CHECK(drv.num_errors() == 2 * 99);
+        CHECK(drv.num_warnings() == 2 * 33);
+    }
+    CHECK(serial.str().starts_with("a.let:1:1: error: a.let 99\n"));
+    CHECK(serial.str() == parallel.str());
+}
+
+/// Records each Diag%nostic as `"msg+note+..."`.
+class ListSink : public fe::DiagSink {
+public:
+    ListSink(std::vector<std::string>& out)
+        : out_(out) {}
+
+    void diag(const fe::Diag& diag) override {
+        auto& s = out_.emplace_back(diag.msg);
+        for (const auto& note : diag.notes) (s += '+') += note.msg;
+    }
+
+private:
+    std::vector<std::string>& out_;
+};
+
+TEST_CASE("Diags::Local notes") {
+    const std::filesystem::path a = "a.let";
+    std::vector<std::string> out;
+    fe::Driver drv;
+    drv.diags().sink(std::make_unique<ListSink>(out)).batch(0);
+
+    drv.err(Loc(&a, {1, 1}), "main");
+    std::thread([&] {
+        fe::Diags::Local local(drv.diags());
+        drv.err(Loc(&a, {5, 1}), "worker");
+        drv.note(Loc(&a, {5, 2}), "worker note");
+    }).join();
+    drv.note(Loc(&a, {1, 2}), "main note"); // the worker's error came in between
+
+    drv.err(Loc(&a, {2, 1}), "main 2");
+    std::thread([&] { drv.note(Loc(&a, {6, 1}), "foreign note"); }).join(); // no Local
+    drv.note(Loc(&a, {2, 2}), "main 2 note");
+
+    drv.err(Loc(&a, {3, 1}), "main 3");
+    drv.note(Loc(&a, {3, 2}), "main 3 note");
+    drv.flush();
+    CHECK(out
+          == std::vector<std::string>{"main", "worker+worker note", "main note", "main 2", "foreign note",
+                                      "main 2 note", "main 3+main 3 note"});
+}
+
+TEST_CASE("Diags max_errors threaded") {
+    static constexpr size_t Max = 10;
+    for (int run = 0; run != 100; ++run) {
+        bool limited = run % 2;
+        std::vector<std::string> out;
+        fe::Driver drv;
+        drv.diags().sink(std::make_unique<ListSink>(out)).batch(0).max_errors(Max);
+        if (limited) drv.diags().max_total(100 * Max);
+
+        std::atomic<bool> go = false;
+        std::vector<std::thread> workers;
+        for (int t = 0; t != 8; ++t)
+            workers.emplace_back([&, t] {
+                fe::Diags::Local local(drv.diags());
+                while (!go) std::this_thread::yield(); // start all at once to provoke the race
+                for (int i = 0; i != 100; ++i) drv.err(Loc(Pos(i + 1)), "{} {}", t, i);
+            });
+        go = true;
+        for (auto& worker : workers) worker.join();
+        drv.flush();
+        CHECK(drv.diags().num_errors() == Max);
+        CHECK(out.size() == Max);
+    }
+}
+
+TEST_CASE("TextSink snippets") {
+    const std::filesystem::path a = "a.let";
+    std::ostringstream os;
+    fe::Driver drv;
+    drv.sources().add(&a, "let x = 1;\n\tλ foo\r\nlast");
+    drv.diags().sink(std::make_unique<fe::TextSink>(os, &drv.sources()));
+
+    drv.err(Loc(&a, {2, 4}, {2, 6}), "unknown '{}'", "foo");
+    drv.note(Loc(&a, {1, 5}, {3, 2}), "multi-line");
+    drv.warn(Loc(&a, {7, 1}), "out of range");
+    drv.flush();
+    CHECK(os.str()
+          == "a.let:2:4-2:6: error: unknown 'foo'\n"
+             "    2 | \tλ foo\n"
+             "      | \t  ^~~\n"
+             "a.let:1:5-3:2: note: multi-line\n"
+             "    1 | let x = 1;\n"
+             "      |     ^~~~~~\n"
+             "a.let:7:1: warning: out of range\n");
+    CHECK(drv.sources().get(&a)->row(0) == 1);
+    CHECK(drv.sources().get(&a)->row(10) == 1);
+    CHECK(drv.sources().get(&a)->row(11) == 2);
+    CHECK(drv.sources().get(&a)->row(12) == 2);
+    CHECK(drv.sources().get(&a)->row(99) == 3);
+}
+
+TEST_CASE("SourceCache") {
+    const auto a = std::filesystem::temp_directory_path() / "fe-source-cache.let";
+    const std::filesystem::path missing = "does/not/exist.let";
+    std::ofstream(a, std::ios::binary) << "let x = 1;\r\nreturn x;";
+
+    fe::SourceCache sources;
+    auto source = sources.get(&a);
+    REQUIRE(source != nullptr);
+    CHECK(source->line(2) == "return x;");
+    CHECK(sources.get(&a) == source); // read only once
+    CHECK(sources.get(&missing) == nullptr);
+
+    // all threads agree on the first one that made it into the cache
+    const auto b = std::filesystem::temp_directory_path() / "fe-source-cache-b.let";
+    std::ofstream(b, std::ios::binary) << "let y = 2;";
+    std::vector<const fe::Source*> results(8);
+    std::vector<std::thread> threads;
+    for (auto& result : results) threads.emplace_back([&] { result = sources.get(&b); });
+    for (auto& thread : threads) thread.join();
+    CHECK(results.front() != nullptr);
+    CHECK(std::ranges::count(results, results.front()) == 8);
+
+    std::filesystem::remove(a);
+    std::filesystem::remove(b);
+}
+
+TEST_CASE("Diags limits") {
+    const std::filesystem::path a = "a.let", b = "b.let";
+    std::ostringstream os;
+    int n = 0;
+    fe::Driver drv;
+    drv.diags().sink(os).dedup(true).max_per_loc(2).max_per_file(3);
+
+    for (int i = 0; i != 1000; ++i) drv.err(Loc(&a, {1, 1}), "macro {}", Spy{&n}); // dedup by format string
+    drv.err("E1", Loc(&a, {1, 1}), "other {}", Spy{&n});
+    drv.err("E2", Loc(&a, {1, 1}), "third {}", Spy{&n}); // max_per_loc
+    drv.warn(Loc(&a, {2, 1}), "w {}", Spy{&n});
+    drv.warn(Loc(&a, {3, 1}), "w {}", Spy{&n}); // max_per_file
+    drv.warn(Loc(&b, {3, 1}), "w {}", Spy{&n});
+    CHECK(n == 4);
+    CHECK(drv.num_errors() == 2);
+    CHECK(drv.diags().num_dropped() == 1000 - 1 + 2);
+
+    drv.diags().summary();
+    CHECK(os.str()
+          == "a.let:1:1: error: macro 1\n"
+             "a.let:1:1: error: other 2\n"
+             "a.let:2:1: warning: w 3\n"
+             "b.let:3:1: warning: w 4\n"
+             "2 errors, 2 warnings (1001 suppressed)\n");
+}
+
+template<> struct fe::is_lazy<Spy> : std::true_type {};
+
+TEST_CASE("Driver::Speculation") {
+    const std::filesystem::path a = "a.let";
+    std::ostringstream os;
+    int n = 0;
+    fe::Driver drv;
+    drv.diags().sink(os);
+
+    {
+        fe::Driver::Speculation spec(drv);
+        drv.err(Loc(&a, {1, 1}), "rolled back {}", Spy{&n});
+        CHECK(spec.num_pending() == 1);
+    }
+    CHECK(n == 0);
+    CHECK(drv.num_errors() == 0);
+
+    {
+        fe::Driver::Speculation outer(drv);
+        drv.err(Loc(&a, {1, 1}), "first {}", Spy{&n});
+        {
+            fe::Driver::Speculation inner(drv);
+            drv.warn(Loc(&a, {2, 1}), "dropped {}", Spy{&n});
+        }
+        {
+            fe::Driver::Speculation inner(drv);
+            drv.warn(Loc(&a, {3, 1}), "{} {}", std::string("eager"), Spy{&n}); // not lazy: formatted right away
+            inner.commit();
+        }
+        CHECK(n == 1);
+        drv.note(Loc(&a, {4, 1}), "last {}", 'x');
+        CHECK(outer.num_pending() == 3);
+        CHECK(drv.num_errors() == 0);
+        outer.commit();
+    }
+    CHECK(n == 2);
+    CHECK(drv.num_errors() == 1);
+    CHECK(drv.num_warnings() == 1);
+
+    drv.flush();
+    CHECK(os.str()
+          == "a.let:1:1: error: first 2\n"
+             "a.let:3:1: warning: eager 1\n"
+             "a.let:4:1: note: last x\n");
+}
+
+TEST_CASE("Driver::Speculation two Drivers") {
+    const std::filesystem::path a = "a.let", b = "b.let";
+    std::ostringstream os1, os2;
+    fe::Driver d1, d2;
+    d1.diags().sink(os1);
+    d2.diags().sink(os2);
+
+    {
+        fe::Driver::Speculation s1(d1);
+        d1.err(Loc(&a, {1, 1}), "a1");
+        {
+            fe::Driver::Speculation s2(d2);
+            d2.err(Loc(&b, {1, 1}), "b1");
+            d1.err(Loc(&a, {2, 1}), "a2");
+            CHECK(s1.num_pending() == 2);
+            CHECK(s2.num_pending() == 1);
+            s2.commit(); // only b1
+            d2.flush();
+        }
+        d1.err(Loc(&a, {3, 1}), "a3");
+    } // rolls back a1, a2, a3
+    CHECK(os1.str().empty());
+    CHECK(os2.str() == "b.let:1:1: error: b1\n");
+    CHECK(d1.num_errors() == 0);
+    CHECK(d2.num_errors() == 1);
+
+    {
+        fe::Driver::Speculation s1(d1);
+        d1.err(Loc(&a, {1, 1}), "a1");
+        {
+            fe::Driver::Speculation s2(d2);
+            d2.err(Loc(&b, {2, 1}), "b2");
+            d1.err(Loc(&a, {2, 1}), "a2");
+        } // rolls back b2 only
+        s1.commit();
+        d1.flush();
+    }
+    CHECK(os1.str() == "a.let:1:1: error: a1\na.let:2:1: error: a2\n");
+    CHECK(os2.str() == "b.let:1:1: error: b1\n");
+    CHECK(d1.num_errors() == 2);
+    CHECK(d2.num_errors() == 1);
+}
@@ -0,0 +1,270 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#endif
+
+#include <doctest/doctest.h>
+#include <fe/ast.h>
+#include <fe/hash_cons.h>
+#include <fe/loc.cpp.h>
+#include <fe/scope_table.h>
+
+#include "corpus.h"
+#include "let.h"
+
+/// @file
+/// Memory budgets of the front end.
+/// This is a program of its own - and, hence, runs in a ctest process of its own - so the peak RSS is not distorted
+/// by whatever the other tests allocated before.
+
+namespace {
+
+class Node;
+class LetStmt;
+class RetStmt;
+class BinExpr;
+class LitExpr;
+class IdExpr;
+class QuoteExpr;
+
+class Node : public fe::ASTNode<Node> {
+public:
+    using Kinds = fe::Kinds<Node, LetStmt, RetStmt, BinExpr, LitExpr, IdExpr, QuoteExpr>;
+};
+
+class LetStmt : public Node {
+public:
+    LetStmt(fe::Sym sym)
+        : sym(sym) {}
+
+    fe::Sym sym;
+};
+
+class RetStmt : public Node {};
+
+class BinExpr : public Node {
+public:
+    BinExpr(Tok::Tag tag)
+        : tag(tag) {}
+
+    Tok::Tag tag;
+};
+
+class LitExpr : public Node {
+public:
+    LitExpr(uint64_t val)
+        : val(val) {}
+
+    uint64_t val;
+};
+
+class IdExpr : public Node {
+public:
+    IdExpr(fe::Sym sym)
+        : sym(sym) {}
+
+    fe::Sym sym;
+};
+
+class QuoteExpr : public Node {};
+
+// clang-format off
+static_assert(sizeof(fe::ASTNode<Node>) <= 4 * sizeof(void*));
+static_assert(sizeof(LetStmt)           <= sizeof(fe::ASTNode<Node>) + sizeof(fe::Sym));
+static_assert(sizeof(BinExpr)           <= sizeof(fe::ASTNode<Node>) + sizeof(uint64_t));
+static_assert(sizeof(LitExpr)           <= sizeof(fe::ASTNode<Node>) + sizeof(uint64_t));
+static_assert(sizeof(IdExpr)            <= sizeof(fe::ASTNode<Node>) + sizeof(fe::Sym));
+// clang-format on
+
+/// Upper bound for a node plus its operands in the AST's Arena: a BinExpr with its two operands is the largest one.
+constexpr size_t Max_Node_Bytes = sizeof(fe::ASTNode<Node>) + sizeof(uint64_t) + 2 * sizeof(Node*);
+
+/// Like the Parser of let.h - but builds an fe::AST.
+class ASTParser : public fe::Parser<Tok, Tok::Tag, 1, ASTParser> {
+public:
+    using Tag = Tok::Tag;
+
+    ASTParser(fe::Driver& driver, std::istream& istream)
+        : lexer_(driver, istream)
+        , driver_(driver) {
+        init(nullptr);
+    }
+
+    Lexer<1>& lexer() { return lexer_; }
+    const fe::AST<Node>& ast() const { return ast_; }
+
+    /// @returns the number of nodes built - the same number that Parser::parse_prog yields.
+    size_t parse_prog() {
+        while (ahead().tag() != Tag::EoF) parse_stmt();
+        return num_nodes_;
+    }
+
+    void syntax_err(Tag tag, std::string_view ctxt) {
+        driver_.err(ahead().loc(), "expected '{}' while parsing {} but got '{}'", Tok::tag2str(tag), ctxt, ahead());
+    }
+
+private:
+    template<class T, class... Args> T* mk(fe::Loc loc, std::initializer_list<Node*> ops, Args&&... args) {
+        ++num_nodes_;
+        return ast_.mk<T>(loc, ops, std::forward<Args>(args)...);
+    }
+
+    Node* parse_stmt() {
+        auto track = tracker();
+        if (accept(Tag::K_let)) {
+            auto id = expect(Tag::M_id, "let statement");
+            expect(Tag::O_ass, "let statement");
+            auto expr = parse_expr("let statement");
+            expect(Tag::T_semicolon, "let statement");
+            return mk<LetStmt>(track, {expr}, id ? id.sym() : fe::Sym());
+        }
+        if (accept(Tag::K_return)) {
+            auto expr = parse_expr("return statement");
+            expect(Tag::T_semicolon, "return statement");
+            return mk<RetStmt>(track, {expr});
+        }
+        driver_.err(ahead().loc(), "expected statement but got '{}'", ahead());
+        lex();
+        return mk<RetStmt>(track, {nullptr});
+    }
+
+    Node* parse_expr(std::string_view ctxt, Tok::Prec prec = Tok::Prec::Bot) {
+        auto track = tracker();
+        auto lhs   = parse_prim(ctxt);
+        while (true) {
+            auto [p, left_assoc] = Tok::tag2prec(ahead().tag());
+            if (p <= prec) break;
+            auto tag = lex().tag();
+            auto rhs = parse_expr("right-hand side of binary expression", left_assoc ? p : Tok::Prec(p - 1));
+            lhs      = mk<BinExpr>(track, {lhs, rhs}, tag);
+        }
+        return lhs;
+    }
+
+    Node* parse_prim(std::string_view ctxt) {
+        auto track = tracker();
+        switch (ahead().tag()) {
+            case Tag::M_id: return mk<IdExpr>(track, {}, lex().sym());
+            case Tag::M_lit: return mk<LitExpr>(track, {}, lex().u64());
+            case Tag::D_paren_l: {
+                lex();
+                auto expr = parse_expr("parenthesized expression");
+                expect(Tag::D_paren_r, "parenthesized expression");
+                return expr;
+            }
+            case Tag::D_quote_l: {
+                lex();
+                auto expr = parse_expr("quoted expression");
+                expect(Tag::D_quote_r, "quoted expression");
+                return mk<QuoteExpr>(track, {expr});
+            }
+            default:
+                driver_.err(ahead().loc(), "expected primary expression while parsing {} but got '{}'", ctxt, ahead());
+                if (ahead().tag() != Tag::EoF) lex();
+                return nullptr;
+        }
+    }
+
+    Lexer<1> lexer_;
+    fe::Driver& driver_;
+    fe::AST<Node> ast_;
+    size_t num_nodes_ = 0;
+};
+
+/// Peak resident set size of this process in bytes or `0` if unknown.
+size_t peak_rss() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#    ifdef __APPLE__
+    return size_t(usage.ru_maxrss); // bytes
+#    else
+    return size_t(usage.ru_maxrss) * 1024; // KB
+#    endif
+#else
+    return 0;
+#endif
+}
+
+struct Cell {
+    uint64_t val;
+    const Cell* next;
+
+    friend bool operator==(const Cell&, const Cell&) = default;
+};
+
+struct CellHash {
+    size_t operator()(const Cell& cell) const {
+        return std::hash<uint64_t>()(cell.val) * 31 + std::hash<const Cell*>()(cell.next);
+    }
+};
+
+} // namespace
+
+TEST_CASE("Parser") {
+    // Whatever the front end holds on to must not grow with the input - only with the vocabulary.
+    size_t num_bytes = 0;
+    for (uint64_t size : {1024 * 1024, 4 * 1024 * 1024}) {
+        auto text = Corpus({.seed = 7, .size = size}).str();
+        auto rss  = peak_rss();
+
+        fe::Driver drv;
+        std::istringstream is(text); // a copy of text
+        CHECK(Parser(drv, is).parse_prog() > 0);
+        CHECK(drv.num_errors() == 0);
+
+        // Corpus::Config::vocab = 1024 identifiers fit into the first page for the strings and the first one for the
+        // hash set - i.e. SymPool never grows beyond the pages its Arena%s start with.
+        CHECK(drv.num_bytes() <= 2 * fe::Arena::Default_Page_Size);
+        if (num_bytes != 0) CHECK(drv.num_bytes() == num_bytes);
+        num_bytes = drv.num_bytes();
+
+        // Neither Lexer nor Parser may hold on to more than a few tokens of the input.
+        if (rss != 0) CHECK(peak_rss() - rss <= text.size() + 4 * fe::Arena::Default_Page_Size);
+    }
+}
+
+TEST_CASE("AST") {
+    auto text = Corpus({.seed = 7, .size = 4 * 1024 * 1024}).str();
+    fe::Driver drv;
+    std::istringstream is(text);
+    auto num_nodes = Parser(drv, is).parse_prog();
+    auto rss       = peak_rss();
+
+    is.clear();
+    is.seekg(0);
+    ASTParser parser(drv, is);
+    CHECK(parser.parse_prog() == num_nodes);
+    CHECK(drv.num_errors() == 0);
+
+    auto num_bytes = parser.ast().num_bytes();
+    CHECK(num_bytes <= num_nodes * Max_Node_Bytes + fe::Arena::Default_Page_Size);
+    // Apart from the AST, building it may not cost more than parsing without it.
+    if (rss != 0) CHECK(peak_rss() - rss <= num_bytes + 4 * fe::Arena::Default_Page_Size);
+}
+
+TEST_CASE("ScopeTable") {
+    constexpr size_t n = 100'000;
+    fe::SymPool syms;
+    std::vector<fe::Sym> names;
+    for (size_t i = 0; i != n; ++i) names.emplace_back(syms.sym(fe::format::format("x{}", i)));
+
+    fe::ScopeTable<void*> scopes;
+    for (auto name : names) scopes.bind(name, nullptr);
+    // A binding is its value, its Sym, the binding it shadows, the next binding of its scope, and its depth.
+    CHECK(scopes.num_bytes() <= n * (sizeof(void*) + 4 * sizeof(uint64_t)) + fe::Arena::Default_Page_Size);
+}
+
+TEST_CASE("HashCons") {
+    constexpr size_t n = 100'000;
+    fe::HashCons<Cell, CellHash> cells;
+    const Cell* cell = nullptr;
+    for (size_t i = 0; i != n; ++i) cell = cells.mk(uint64_t(i), cell);
+    CHECK(cells.size() == n);
+    // Without FE_ABSL, the hash set adds a node of three words per Cell plus its bucket arrays, which the Arena never
+    // frees: up to four words per Cell over all rehashes.
+    CHECK(cells.num_bytes() <= n * (sizeof(Cell) + 7 * sizeof(void*)) + 2 * fe::Arena::Default_Page_Size);
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <initializer_list>
+#include <span>
+
+#include <doctest/doctest.h>
+#include <fe/hash_cons.h>
+
+namespace {
+
+struct Type {
+    enum class Tag { Bool, Int, Tuple, Fn };
+
+    /// Copies @p ops into @p arena - which HashCons::mk rolls back again in the case of a duplicate.
+    Type(fe::Arena& arena, Tag tag, std::initializer_list<const Type*> ops = {})
+        : tag(tag)
+        , ops(arena.allocate<const Type*>(ops.size()), ops.size()) {
+        std::ranges::copy(ops, this->ops.begin());
+    }
+
+    friend bool operator==(const Type& t1, const Type& t2) {
+        return t1.tag == t2.tag && std::ranges::equal(t1.ops, t2.ops); // ops are hash-consed: compare pointers
+    }
+
+    Tag tag;
+    std::span<const Type*> ops;
+};
+
+struct TypeHash {
+    size_t operator()(const Type& type) const {
+        auto hash = std::hash<int>()(int(type.tag));
+        for (auto op : type.ops) hash = hash * 31 + std::hash<const Type*>()(op);
+        return hash;
+    }
+};
+
+} // namespace
+
+TEST_CASE("HashCons") {
+    using Tag = Type::Tag;
+    fe::HashCons<Type, TypeHash> types;
+    auto& arena = types.arena();
+    auto mk     = [&](Tag tag, std::initializer_list<const Type*> ops = {}) { return types.mk(arena, tag, ops); };
+
+    auto b = mk(Tag::Bool);
+    auto i = mk(Tag::Int);
+    CHECK(b != i);
+    CHECK(b == mk(Tag::Bool));
+    CHECK(i == mk(Tag::Int));
+
+    auto fn = mk(Tag::Fn, {i, b});
+    CHECK(fn != mk(Tag::Fn, {b, i}));
+    CHECK(types.size() == 4);
+
+    // a duplicate - including its ops - doesn't consume any memory
+    auto state = arena.state();
+    CHECK(fn == mk(Tag::Fn, {mk(Tag::Int), mk(Tag::Bool)}));
+    CHECK(arena.state() == state);
+    CHECK(types.size() == 4);
+
+    auto tuple = mk(Tag::Tuple, {fn, fn, i});
+    CHECK(tuple->ops.size() == 3);
+    CHECK(tuple->ops[0] == fn);
+    CHECK(arena.state() != state);
+    CHECK(tuple == mk(Tag::Tuple, {fn, fn, i}));
+    CHECK(types.size() == 5);
+
+    // survives page boundaries
+    fe::HashCons<Type, TypeHash> small(64);
+    auto mk_small = [&](Tag tag, std::initializer_list<const Type*> ops = {}) {
+        return small.mk(small.arena(), tag, ops);
+    };
+    auto prev = mk_small(Tag::Int);
+    for (int n = 0; n != 100; ++n) {
+        auto next = mk_small(Tag::Tuple, {prev, prev});
+        CHECK(next == mk_small(Tag::Tuple, {prev, prev}));
+        prev = next;
+    }
+    CHECK(small.size() == 101);
+    CHECK(small.arena().num_pages() > 1);
+
+    auto moved = std::move(small);
+    CHECK(moved.size() == 101);
+    CHECK(moved.mk(moved.arena(), Tag::Int)->tag == Tag::Int);
+    CHECK(moved.size() == 101);
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstdlib>
+
+#include <fe/driver.h>
+#include <fe/lexer.h>
+#include <fe/parser.h>
+
+/// @file
+/// The Let language: a tiny expression language used by tests and benchmarks.
+/// ```
+/// prog = stmt* EoF
+/// stmt = 'let' id '=' expr ';'
+///      | 'return' expr ';'
+/// expr = prim (op expr)*
+/// prim = id | lit | '(' expr ')' | '«' expr '»'
+/// ```
+/// `//` starts a comment that extends to the end of the line.
+
+// clang-format off
+#define LET_KEY(m)          \
+    m(K_let, "let")         \
+    m(K_return, "return")
+
+#define LET_MISC(m)         \
+    m(M_id, "<identifier>") \
+    m(M_lit, "<literal>")
+
+#define LET_TOK(m)          \
+    m(D_paren_l, "(")       \
+    m(D_paren_r, ")")       \
+    m(D_quote_l, "«")       \
+    m(D_quote_r, "»")       \
+    m(T_semicolon, ";")     \
+    m(T_lambda, "λ")        \
+    m(EoF, "<end of file>")
+
+#define LET_OP(m)            \
+    m(O_add, "+", Add, true) \
+    m(O_sub, "-", Add, true) \
+    m(O_mul, "*", Mul, true) \
+    m(O_div, "/", Mul, true) \
+    m(O_ass, "=", Ass, false)
+// clang-format on
+
+class Tok {
+public:
+    enum Tag {
+        Nil,
+#define CODE(t, str) t,
+        LET_KEY(CODE) LET_MISC(CODE) LET_TOK(CODE)
+#undef CODE
+#define CODE(t, str, prec, left_assoc) t,
+            LET_OP(CODE)
+#undef CODE
+    };
+
+    enum Prec { Err, Bot, Ass, Add, Mul };
+
+    Tok() {}
+    Tok(fe::Loc loc, Tag tag)
+        : loc_(loc)
+        , tag_(tag) {}
+    Tok(fe::Loc loc, fe::Sym sym)
+        : loc_(loc)
+        , tag_(Tag::M_id)
+        , sym_(sym) {}
+    Tok(fe::Loc loc, uint64_t u64)
+        : loc_(loc)
+        , tag_(Tag::M_lit)
+        , u64_(u64) {}
+
+    Tag tag() const { return tag_; }
+    fe::Loc loc() const { return loc_; }
+    fe::Sym sym() const {
+        assert(tag_ == Tag::M_id);
+        return sym_;
+    }
+    uint64_t u64() const {
+        assert(tag_ == Tag::M_lit);
+        return u64_;
+    }
+    explicit operator bool() const { return tag_ != Tag::Nil; }
+
+    static const char* tag2str(Tag tag) {
+        switch (tag) {
+#define CODE(t, str) \
+    case Tok::Tag::t: return str;
+            LET_KEY(CODE)
+            LET_TOK(CODE)
+            LET_MISC(CODE)
+#undef CODE
+#define CODE(t, str, prec, left_assoc) \
+    case Tok::Tag::t: return str;
+            LET_OP(CODE)
+#undef CODE
+            default: fe::unreachable();
+        }
+    }
+
+    /// @returns precedence and whether @p tag is left-associative, or Prec::Err if @p tag is no binary operator.
+    static std::pair<Prec, bool> tag2prec(Tag tag) {
+        switch (tag) {
+#define CODE(t, str, prec, left_assoc) \
+    case Tok::Tag::t: return {Prec::prec, left_assoc};
+            LET_OP(CODE)
+#undef CODE
+            default: return {Prec::Err, false};
+        }
+    }
+
+    std::string to_string() const {
+        if (tag_ == M_id) return sym_.str();
+        if (tag_ == M_lit) return std::to_string(u64_);
+        return tag2str(tag_);
+    }
+
+    template<class O> O format_to(O out) const {
+        if (tag_ == M_id) return fe::format::format_to(out, "{}", sym_);
+        if (tag_ == M_lit) return fe::format::format_to(out, "{}", u64_);
+        return fe::format::format_to(out, "{}", tag2str(tag_));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, Tok tok) { return os << tok.to_string(); }
+
+private:
+    fe::Loc loc_;
+    Tag tag_ = Tag::Nil;
+    union {
+        fe::Sym sym_;
+        uint64_t u64_;
+    };
+};
+
+// Tokens live in the Parser's lookahead Ring; make sure a Tok stays at four words (on 64-bit).
+static_assert(sizeof(Tok) <= sizeof(fe::Loc) + 2 * sizeof(uint64_t));
+
+template<> struct fe::format::formatter<Tok> : fe::direct_formatter<Tok> {};
+
+template<size_t K = 1> class Lexer : public fe::Lexer<K, Lexer<K>> {
+public:
+    using fe::Lexer<K, Lexer<K>>::ahead;
+    using fe::Lexer<K, Lexer<K>>::accept;
+    using fe::Lexer<K, Lexer<K>>::next;
+
+    using fe::Lexer<K, Lexer<K>>::loc_;
+    using fe::Lexer<K, Lexer<K>>::peek_;
+    using fe::Lexer<K, Lexer<K>>::str_;
+
+    Lexer(fe::Driver& driver, std::istream& istream, const std::filesystem::path* path = nullptr)
+        : fe::Lexer<K, Lexer<K>>(istream, path)
+        , driver_(driver) {
+#define CODE(t, str) keywords_[driver_.sym(str)] = Tok::Tag::t;
+        LET_KEY(CODE)
+#undef CODE
+    }
+
+    Tok lex() {
+        while (true) {
+            this->start();
+
+            if (accept(fe::utf8::Null)) {
+                driver_.err(loc_, "invalid UTF-8 sequence");
+                continue;
+            }
+
+            if (accept(fe::utf8::EoF)) return {loc_, Tok::Tag::EoF};
+            if (accept(fe::utf8::isspace)) continue;
+
+            if (accept('(')) return {loc_, Tok::Tag::D_paren_l};
+            if (accept(')')) return {loc_, Tok::Tag::D_paren_r};
+            if (accept(U'«')) return {loc_, Tok::Tag::D_quote_l};
+            if (accept(U'»')) return {loc_, Tok::Tag::D_quote_r};
+
+            if (accept('+')) return {loc_, Tok::Tag::O_add};
+            if (accept('-')) return {loc_, Tok::Tag::O_sub};
+            if (accept('*')) return {loc_, Tok::Tag::O_mul};
+            if (accept('/')) {
+                if (accept('/')) { // line comment
+                    while (ahead() != '\n' && ahead() != fe::utf8::EoF) next();
+                    continue;
+                }
+                return {loc_, Tok::Tag::O_div};
+            }
+            if (accept('=')) return {loc_, Tok::Tag::O_ass};
+
+            if (accept(';')) return {loc_, Tok::Tag::T_semicolon};
+
+            if (accept(U'λ')) return {loc_, Tok::Tag::T_lambda};
+
+            if (accept([](char32_t c) { return c == '_' || fe::utf8::isalpha(c); })) {
+                while (accept([](char32_t c) { return c == '_' || c == '.' || fe::utf8::isalnum(c); })) {}
+                auto sym = driver_.sym(str_);
+                if (auto i = keywords_.find(sym); i != keywords_.end()) return {loc_, i->second};
+                return {loc_, sym};
+            }
+
+            if (accept(fe::utf8::isdigit)) {
+                while (accept(fe::utf8::isdigit)) {}
+                auto u = strtoull(str_.c_str(), nullptr, 10);
+                return {loc_, u};
+            }
+
+            driver_.err(peek_, "invalid input character: '{}'", fe::utf8::Char32(ahead()));
+            next();
+        }
+    }
+
+private:
+    fe::Driver& driver_;
+    fe::SymMap<Tok::Tag> keywords_;
+};
+
+class Parser : public fe::Parser<Tok, Tok::Tag, 1, Parser> {
+public:
+    using Tag = Tok::Tag;
+
+    Parser(fe::Driver& driver, std::istream& istream, const std::filesystem::path* path = nullptr)
+        : lexer_(driver, istream, path)
+        , driver_(driver) {
+        init(path);
+    }
+
+    Lexer<1>& lexer() { return lexer_; }
+
+    /// There is no AST; instead, all parse functions return the number of nodes they would have built.
+    size_t parse_prog() {
+        FE_TRACE_SCOPE("Parser::parse_prog");
+        size_t num = 0;
+        while (ahead().tag() != Tag::EoF) num += parse_stmt();
+        return num;
+    }
+
+    void syntax_err(Tag tag, std::string_view ctxt) {
+        driver_.err(ahead().loc(), "expected '{}' while parsing {} but got '{}'", Tok::tag2str(tag), ctxt, ahead());
+    }
+
+private:
+    size_t parse_stmt() {
+        size_t num = 1;
+        if (accept(Tag::K_let)) {
+            expect(Tag::M_id, "let statement");
+            expect(Tag::O_ass, "let statement");
+            num += parse_expr("let statement");
+            expect(Tag::T_semicolon, "let statement");
+        } else if (accept(Tag::K_return)) {
+            num += parse_expr("return statement");
+            expect(Tag::T_semicolon, "return statement");
+        } else {
+            driver_.err(ahead().loc(), "expected statement but got '{}'", ahead());
+            lex();
+        }
+        return num;
+    }
+
+    /// [Precedence climbing](https://en.wikipedia.org/wiki/Operator-precedence_parser#Precedence_climbing_method).
+    size_t parse_expr(std::string_view ctxt, Tok::Prec prec = Tok::Prec::Bot) {
+        auto num = parse_prim(ctxt);
+        while (true) {
+            auto [p, left_assoc] = Tok::tag2prec(ahead().tag());
+            if (p <= prec) break;
+            lex();
+            num += 1 + parse_expr("right-hand side of binary expression", left_assoc ? p : Tok::Prec(p - 1));
+        }
+        return num;
+    }
+
+    size_t parse_prim(std::string_view ctxt) {
+        switch (ahead().tag()) {
+            case Tag::M_id:
+            case Tag::M_lit: return lex(), 1;
+            case Tag::D_paren_l: {
+                lex();
+                auto num = parse_expr("parenthesized expression");
+                expect(Tag::D_paren_r, "parenthesized expression");
+                return num;
+            }
+            case Tag::D_quote_l: {
+                lex();
+                auto num = parse_expr("quoted expression");
+                expect(Tag::D_quote_r, "quoted expression");
+                return num + 1;
+            }
+            default:
+                driver_.err(ahead().loc(), "expected primary expression while parsing {} but got '{}'", ctxt, ahead());
+                if (ahead().tag() != Tag::EoF) lex();
+                return 0;
+        }
+    }
+
+    Lexer<1> lexer_;
+    fe::Driver& driver_;
+};
@@ -1,10 +1,12 @@
 #include <sstream>
+#include <unordered_set>
 
 #include <doctest/doctest.h>
-#include <fe/driver.h>
-#include <fe/lexer.h>
 #include <fe/loc.cpp.h>
-#include <fe/parser.h>
+#include <fe/trace.h>
+
+#include "corpus.h"
+#include "let.h"
 
 using fe::Loc;
 using fe::Pos;
@@ -12,161 +14,6 @@ using fe::Sym;
 
 namespace utf8 = fe::utf8;
 
-// clang-format off
-#define LET_KEY(m)          \
-    m(K_let, "let")         \
-    m(K_return, "return")
-
-#define LET_MISC(m)         \
-    m(M_id, "<identifier>") \
-    m(M_lit, "<literal>")
-
-#define LET_TOK(m)          \
-    m(D_paren_l, "(")       \
-    m(D_paren_r, ")")       \
-    m(D_quote_l, "«")       \
-    m(D_quote_r, "»")       \
-    m(T_semicolon, ";")     \
-    m(T_lambda, "λ")        \
-    m(EoF, "<end of file>")
-
-#define LET_OP(m)            \
-    m(O_add, "+", Add, true) \
-    m(O_sub, "-", Add, true) \
-    m(O_mul, "*", Mul, true) \
-    m(O_div, "/", Mul, true) \
-    m(O_ass, "=", ASS, false)
-// clang-format on
-
-class Tok {
-public:
-    enum Tag {
-        Nil,
-#define CODE(t, str) t,
-        LET_KEY(CODE) LET_MISC(CODE) LET_TOK(CODE)
-#undef CODE
-#define CODE(t, str, prec, left_assoc) t,
-            LET_OP(CODE)
-#undef CODE
-    };
-
-    enum Prec { Err, Bot, Ass, Add, Mul };
-
-    Tok() {}
-    Tok(Loc loc, Tag tag)
-        : loc_(loc)
-        , tag_(tag) {}
-    Tok(Loc loc, Sym sym)
-        : loc_(loc)
-        , tag_(Tag::M_id)
-        , sym_(sym) {}
-    Tok(Loc loc, uint64_t u64)
-        : loc_(loc)
-        , tag_(Tag::M_lit)
-        , u64_(u64) {}
-
-    Tag tag() const { return tag_; }
-    Loc loc() const { return loc_; }
-    explicit operator bool() const { return tag_ != Tag::Nil; }
-
-    static const char* tag2str(Tag tag) {
-        switch (tag) {
-#define CODE(t, str) \
-    case Tok::Tag::t: return str;
-            LET_KEY(CODE)
-            LET_TOK(CODE)
-            LET_MISC(CODE)
-#undef CODE
-#define CODE(t, str, prec, left_assoc) \
-    case Tok::Tag::t: return str;
-            LET_OP(CODE)
-#undef CODE
-            default: fe::unreachable();
-        }
-    }
-
-    std::string to_string() const {
-        if (tag_ == M_id) return sym_.str();
-        if (tag_ == M_lit) return std::to_string(u64_);
-        return tag2str(tag_);
-    }
-
-    friend std::ostream& operator<<(std::ostream& os, Tok tok) { return os << tok.to_string(); }
-
-private:
-    Loc loc_;
-    Tag tag_ = Tag::Nil;
-    union {
-        Sym sym_;
-        uint64_t u64_;
-    };
-};
-
-template<> struct fe::format::formatter<Tok> : fe::ostream_formatter {};
-
-template<size_t K = 1> class Lexer : public fe::Lexer<K, Lexer<K>> {
-public:
-    using fe::Lexer<K, Lexer<K>>::ahead;
-    using fe::Lexer<K, Lexer<K>>::accept;
-    using fe::Lexer<K, Lexer<K>>::next;
-
-    using fe::Lexer<K, Lexer<K>>::loc_;
-    using fe::Lexer<K, Lexer<K>>::peek_;
-    using fe::Lexer<K, Lexer<K>>::str_;
-
-    Lexer(fe::Driver& driver, std::istream& istream, const std::filesystem::path* path = nullptr)
-        : fe::Lexer<K, Lexer<K>>(istream, path)
-        , driver_(driver) {}
-
-    Tok lex() {
-        while (true) {
-            this->start();
-
-            if (accept(utf8::Null)) {
-                std::cerr << "invalid UTF-8 sequence" << std::endl;
-                continue;
-            }
-
-            if (accept(utf8::EoF)) return {loc_, Tok::Tag::EoF};
-            if (accept(utf8::isspace)) continue;
-
-            if (accept('(')) return {loc_, Tok::Tag::D_paren_l};
-            if (accept('(')) return {loc_, Tok::Tag::D_paren_r};
-            if (accept(U'«')) return {loc_, Tok::Tag::D_quote_l};
-            if (accept(U'»')) return {loc_, Tok::Tag::D_quote_r};
-
-            if (accept('+')) return {loc_, Tok::Tag::O_add};
-            if (accept('-')) return {loc_, Tok::Tag::O_sub};
-            if (accept('*')) return {loc_, Tok::Tag::O_mul};
-            if (accept('/')) return {loc_, Tok::Tag::O_div};
-            if (accept('=')) return {loc_, Tok::Tag::O_ass};
-
-            if (accept(';')) return {loc_, Tok::Tag::T_semicolon};
-
-            if (accept(U'λ')) return {loc_, Tok::Tag::T_lambda};
-
-            if (accept([](char32_t c) { return c == '_' || utf8::isalpha(c); })) {
-                while (accept([](char32_t c) { return c == '_' || c == '.' || utf8::isalnum(c); })) {}
-                return {loc_, driver_.sym(str_)};
-            }
-
-            if (accept(utf8::isdigit)) {
-                while (accept(utf8::isdigit)) {}
-                auto u = strtoull(str_.c_str(), nullptr, 10);
-                return {loc_, u};
-            }
-
-            driver_.err(peek_, "invalid input character: ''{}'", utf8::Char32(ahead()));
-            next();
-        }
-    }
-
-private:
-    fe::Driver& driver_;
-};
-
-class Parser : public fe::Parser<Tok, Tok::Tag, 1, Parser> {};
-
 template<size_t K> void test_lexer() {
     fe::Driver drv;
     std::istringstream is(" test  abc    def if  \nwhile λ foo «n; X»  ");
@@ -213,3 +60,75 @@ TEST_CASE("Lexer") {
     test_lexer<2>();
     test_lexer<3>();
 }
+
+TEST_CASE("Parser") {
+    std::ostringstream os;
+    fe::Driver drv;
+    drv.diags().sink(os);
+
+    std::istringstream is("let x = (a + 23) * b = c;\nreturn «x - 1» / y;\n");
+    Parser parser(drv, is);
+    CHECK(parser.parse_prog() == 15);
+    CHECK(drv.num_errors() == 0);
+
+    std::istringstream err("let = 3;\nreturn (x;");
+    Parser(drv, err).parse_prog();
+    drv.flush();
+    CHECK(os.str()
+          == "<unknown file>:1:5: error: expected '<identifier>' while parsing let statement but got '='\n"
+             "<unknown file>:2:10: error: expected ')' while parsing parenthesized expression but got ';'\n");
+}
+
+TEST_CASE("Corpus") {
+    Corpus::Config config{.seed = 42, .size = 64 * 1024, .id_min = 2, .id_max = 5, .unicode = .3, .comments = .5};
+    auto text = Corpus(config).str();
+    CHECK(text.size() >= config.size);
+    CHECK(text == Corpus(config).str());
+    CHECK(text != Corpus({.seed = 43, .size = config.size}).str());
+    CHECK(text.find("«") != std::string::npos);
+    CHECK(text.find("//") != std::string::npos);
+
+    Corpus corpus(config);
+    const auto& vocab = corpus.vocab();
+    CHECK(vocab.size() == config.vocab);
+    CHECK(std::unordered_set<std::string>(vocab.begin(), vocab.end()).size() == vocab.size());
+    CHECK(Corpus({.id_min = 1, .id_max = 1}).vocab().size() == 53); // only 53 identifiers of length 1
+
+    fe::Driver drv;
+    std::istringstream is(text);
+    CHECK(Parser(drv, is).parse_prog() > 0);
+    CHECK(drv.num_errors() == 0);
+}
+
+#ifdef FE_TRACE
+TEST_CASE("Trace") {
+    auto& trace = fe::Trace::get();
+    trace.clear();
+    {
+        std::ostringstream os;
+        fe::Driver drv;
+        drv.diags().sink(os);
+        std::istringstream is("let x = a_long_identifier + 1;\nreturn x; // done\n");
+        Parser(drv, is).parse_prog();
+        drv.err(Loc(), "error");
+        drv.flush();
+        FE_TRACE_SCOPE("say \"hi\"\\");
+    }
+    using C = fe::Trace::Counter;
+    CHECK(trace.counter(C::Tokens) == 11);
+    CHECK(trace.counter(C::Sym_Lookups) == 5 + 2); // 2 keywords
+    CHECK(trace.counter(C::Diags) == 1);
+    CHECK(trace.counter(C::Sym_Interned) == 1);
+    CHECK(trace.counter(C::Arena_Bytes) > 0);
+    CHECK(trace.counter(C::Sym_ns) > 0);
+    CHECK(trace.counter(C::Lex_ns) > 0);
+
+    std::ostringstream os;
+    trace.write(os);
+    CHECK(os.str().find(R"("name":"Parser::parse_prog","ph":"X")") != std::string::npos);
+    CHECK(os.str().find(R"("name":"Diags::flush","ph":"X")") != std::string::npos);
+    CHECK(os.str().find(R"("name":"say \"hi\"\\","ph":"X")") != std::string::npos);
+    CHECK(os.str().find(R"("tokens":11)") != std::string::npos);
+    CHECK(os.str().find(R"("lex_ns":)") != std::string::npos);
+}
+#endif
@@ -0,0 +1,11 @@
+// Only the module may provide what follows - hence, no #include.
+import fe;
+
+int main() {
+    fe::Driver driver;
+    auto sym = driver.sym("a_long_identifier");
+    bool ok  = sym == driver.sym("a_long_identifier");
+    ok &= fe::format::formatted_size("{}", sym) == 17;
+    ok &= fe::utf8::isalpha(U'a') && !fe::utf8::isdigit(U'a');
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include <doctest/doctest.h>
+#include <fe/scope_table.h>
+
+TEST_CASE("ScopeTable") {
+    fe::SymPool pool;
+    auto x = pool.sym("x"), y = pool.sym("y"), z = pool.sym("z");
+
+    fe::ScopeTable<int> scopes;
+    CHECK(scopes.depth() == 0);
+    CHECK(scopes.find(x) == nullptr);
+    CHECK(scopes.bind(x, 1));
+    CHECK(scopes.bind(y, 2));
+    CHECK(!scopes.bind(x, 3));
+    CHECK(*scopes.find(x) == 1);
+
+    auto depth = scopes.depth();
+    {
+        auto scope = scopes.scope();
+        CHECK(scopes.depth() == 1);
+        CHECK(*scopes.find(x) == 1);
+        CHECK(scopes.find_local(x) == nullptr);
+        CHECK(scopes.bind(x, 10));
+        CHECK(scopes.bind(z, 30));
+        CHECK(!scopes.bind(z, 31));
+        CHECK(*scopes.find_local(z) == 30);
+
+        scopes.push();
+        CHECK(scopes.bind(x, 100));
+        CHECK(*scopes.find(x) == 100);
+        CHECK(*scopes.find(y) == 2);
+        CHECK(*scopes.find(z) == 30);
+        scopes.pop();
+
+        CHECK(*scopes.find(x) == 10);
+        CHECK(*scopes.find(z) == 30);
+    }
+    CHECK(scopes.depth() == depth);
+    CHECK(*scopes.find(x) == 1);
+    CHECK(*scopes.find(y) == 2);
+    CHECK(scopes.find(z) == nullptr);
+    CHECK(scopes.find_local(y) != nullptr);
+
+    *scopes.find(y) = 20;
+    const auto& cscopes = scopes;
+    CHECK(*cscopes.find(y) == 20);
+
+    // deep nesting across Arena pages; popping reuses the memory
+    fe::ScopeTable<int> deep(256);
+    for (int i = 0; i != 1000; ++i) {
+        deep.push();
+        CHECK(deep.bind(x, i));
+        if (i % 2 == 0) CHECK(deep.bind(y, i));
+    }
+    CHECK(*deep.find(x) == 999);
+    CHECK(*deep.find(y) == 998);
+    for (int i = 999; i != 499; --i) deep.pop();
+    CHECK(*deep.find(x) == 499);
+    CHECK(*deep.find(y) == 498);
+    auto num_bytes = deep.num_bytes();
+    for (int i = 0; i != 1000; ++i) {
+        auto scope = deep.scope();
+        CHECK(deep.bind(z, i));
+    }
+    CHECK(deep.num_bytes() == num_bytes);
+    while (deep.depth() != 0) deep.pop();
+    CHECK(deep.find(x) == nullptr);
+    CHECK(deep.find(y) == nullptr);
+}
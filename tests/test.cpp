@@ -1,11 +1,17 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include <tuple>
+
 #include <doctest/doctest.h>
 #include <fe/arena.h>
+#include <fe/cast.h>
 #include <fe/enum.h>
+#include <fe/format.h>
+#include <fe/fragments.h>
 #include <fe/ring.h>
 #include <fe/sym.h>
 #include <fe/utf8.h>
+#include <fe/writer.h>
 
 using namespace std::literals;
 
@@ -13,6 +19,12 @@ TEST_CASE("Arena") {
     fe::Arena arena;
     std::vector<int, fe::Arena::Allocator<int>> v(arena.allocator<int>());
     for (int i = 0, e = 10000; i != e; ++i) v.emplace_back(i);
+    CHECK(arena.num_pages() == 1);
+    CHECK(arena.num_bytes() == fe::Arena::Default_Page_Size);
+
+    (void)arena.allocate(2 * fe::Arena::Default_Page_Size);
+    CHECK(arena.num_pages() == 2);
+    CHECK(arena.num_bytes() == 3 * fe::Arena::Default_Page_Size);
 }
 
 TEST_CASE("Ring") {
@@ -93,6 +105,13 @@ TEST_CASE("Sym") {
     CHECK(syms.sym("abcdefghi") == syms.sym("abcdefghi"s));
     CHECK(syms.sym("abcdefghij") == syms.sym("abcdefghij"s));
 
+    for (auto s : {"a"sv, "abcdef"sv, "abcdefg"sv}) { // short and long
+        auto sym = syms.sym(s);
+        for (size_t i = 0; i != s.size(); ++i) CHECK(sym[i] == s[i]);
+        CHECK(sym.front() == s.front());
+        CHECK(sym.back() == s.back());
+    }
+
     auto abc = syms.sym("abc");
     auto x   = syms.sym("");
     auto b   = syms.sym("b");
@@ -117,6 +136,13 @@ TEST_CASE("Sym") {
     CHECK(empty.empty());
     CHECK(empty.size() == 0);
     CHECK(!empty);
+
+    // non-ASCII and embedded '\0' - short and long
+    CHECK(syms.sym("ä").view() == "ä"s);
+    CHECK(syms.sym("λ«»").view() == "λ«»"s);
+    CHECK(syms.sym("a\0b"sv).view() == "a\0b"sv);
+    CHECK(syms.sym("a\0b"sv) != syms.sym("a\0c"sv));
+    CHECK(syms.sym("abcdefgh\0a"sv) != syms.sym("abcdefgh\0b"sv));
 }
 
 TEST_CASE("utf8") {
@@ -127,12 +153,200 @@ TEST_CASE("utf8") {
     fe::utf8::encode(oss, U'𐄂');
     fe::utf8::encode(oss, U'𐀮');
     CHECK(oss.str() == "a£λ𐄂𐀮");
+
+    std::istringstream iss("\xf4\x8f\xbf\xbf\xf4\x90\x80\x80\xf7\xbf\xbf\xbfx"); // U+10FFFF, beyond U+10FFFF
+    CHECK(fe::utf8::decode(iss) == U'\U0010ffff');
+    CHECK(fe::utf8::decode(iss) == fe::utf8::Null);
+    CHECK(fe::utf8::decode(iss) == fe::utf8::Null);
+    CHECK(fe::utf8::decode(iss) == U'x');
     CHECK(fe::utf8::any('a', 'b', 'c')('a'));
     CHECK(fe::utf8::any('a', 'b', 'c')('b'));
     CHECK(fe::utf8::any('a', 'b', 'c')('c'));
     CHECK(fe::utf8::any('a', 'b', 'c')('x') == false);
 }
 
+namespace {
+
+class Expr;
+class BinExpr;
+class AddExpr;
+class MulExpr;
+class LitExpr;
+using ExprKinds = fe::Kinds<Expr, fe::Kinds<BinExpr, AddExpr, MulExpr>, LitExpr>;
+
+static_assert(ExprKinds::size == 5);
+static_assert(ExprKinds::kind<Expr> == 0 && ExprKinds::kind<BinExpr> == 1 && ExprKinds::kind<AddExpr> == 2);
+static_assert(ExprKinds::kind<MulExpr> == 3 && ExprKinds::kind<LitExpr> == 4);
+static_assert(ExprKinds::range<BinExpr>().first == 1 && ExprKinds::range<BinExpr>().last == 3);
+static_assert(!ExprKinds::range<int>());
+
+class Expr : public fe::RuntimeCast<Expr> {
+public:
+    using Kinds = ExprKinds;
+
+    Expr(size_t kind)
+        : kind_(kind) {}
+    virtual ~Expr() = default;
+
+    size_t kind() const { return kind_; }
+
+private:
+    size_t kind_;
+};
+
+class BinExpr : public Expr {
+public:
+    using Expr::Expr;
+};
+
+class AddExpr : public BinExpr {
+public:
+    AddExpr()
+        : BinExpr(Kinds::kind<AddExpr>) {}
+};
+
+class MulExpr : public BinExpr {
+public:
+    MulExpr()
+        : BinExpr(Kinds::kind<MulExpr>) {}
+};
+
+class LitExpr : public Expr {
+public:
+    LitExpr()
+        : Expr(Kinds::kind<LitExpr>) {}
+};
+
+// without Kinds: exact match via Node or dynamic_cast
+class Stmt : public fe::RuntimeCast<Stmt> {
+public:
+    enum Tag { Let, Ret };
+
+    Stmt(Tag tag)
+        : tag_(tag) {}
+    virtual ~Stmt() = default;
+
+    Tag node() const { return tag_; }
+
+private:
+    Tag tag_;
+};
+
+class LetStmt : public Stmt {
+public:
+    static constexpr auto Node = Let;
+    LetStmt()
+        : Stmt(Let) {}
+};
+
+class RetStmt : public Stmt {
+public:
+    RetStmt()
+        : Stmt(Ret) {}
+};
+
+} // namespace
+
+TEST_CASE("RuntimeCast") {
+    AddExpr add;
+    MulExpr mul;
+    LitExpr lit;
+    const Expr* exprs[] = {&add, &mul, &lit};
+
+    CHECK(exprs[0]->isa<Expr>() == &add);
+    CHECK(exprs[0]->isa<BinExpr>() == &add);
+    CHECK(exprs[0]->isa<AddExpr>() == &add);
+    CHECK(exprs[0]->isa<MulExpr>() == nullptr);
+    CHECK(exprs[0]->isa<LitExpr>() == nullptr);
+    CHECK(exprs[1]->isa<BinExpr>() == &mul);
+    CHECK(exprs[1]->isa<AddExpr>() == nullptr);
+    CHECK(exprs[2]->isa<BinExpr>() == nullptr);
+    CHECK(exprs[2]->isa<LitExpr>() == &lit);
+    CHECK(exprs[2]->isa<AddExpr, LitExpr>() == &lit);
+    CHECK(exprs[1]->isa<AddExpr, LitExpr>() == nullptr);
+    CHECK(exprs[1]->as<BinExpr>() == &mul);
+
+    LetStmt let;
+    RetStmt ret;
+    Stmt* s = &let;
+    CHECK(s->isa<LetStmt>() == &let);
+    CHECK(s->isa<RetStmt>() == nullptr);
+    s = &ret;
+    CHECK(s->isa<LetStmt>() == nullptr);
+    CHECK(s->isa<RetStmt>() == &ret);
+}
+
+TEST_CASE("visit") {
+    AddExpr add;
+    MulExpr mul;
+    LitExpr lit;
+
+    auto prec = [](const Expr& e) {
+        return fe::visit(
+            e, [](const AddExpr&) { return 1; }, [](const BinExpr&) { return 2; }, [](const Expr&) { return 0; });
+    };
+    CHECK(prec(add) == 1);
+    CHECK(prec(mul) == 2);
+    CHECK(prec(lit) == 0);
+
+    Expr& e = mul; // non-const: overloads may take non-const references
+    fe::visit(e, [](MulExpr& m) { CHECK(m.kind() == Expr::Kinds::kind<MulExpr>); }, [](Expr&) { CHECK(false); });
+
+    LetStmt let;
+    RetStmt ret;
+    auto name = [](const Stmt& s) {
+        return fe::visit<LetStmt>(s, [](const LetStmt&) { return "let"; }, [](const Stmt&) { return "stmt"; });
+    };
+    CHECK(name(let) == "let"s);
+    CHECK(name(ret) == "stmt"s);
+}
+
+namespace {
+// wide hierarchies: Wide<N> has the subclasses Leaf<N, 0>, ..., Leaf<N, N - 1>
+template<size_t N> class Wide;
+template<size_t N, size_t I> class Leaf;
+template<size_t N, class = std::make_index_sequence<N>> struct WideKinds;
+template<size_t N, size_t... Is> struct WideKinds<N, std::index_sequence<Is...>> {
+    using type = fe::Kinds<Wide<N>, Leaf<N, Is>...>;
+};
+
+template<size_t N> class Wide {
+public:
+    using Kinds = typename WideKinds<N>::type;
+
+    Wide(size_t kind)
+        : kind_(kind) {}
+
+    size_t kind() const { return kind_; }
+
+private:
+    size_t kind_;
+};
+
+template<size_t N, size_t I> class Leaf : public Wide<N> {
+public:
+    Leaf()
+        : Wide<N>(Wide<N>::Kinds::template kind<Leaf>) {}
+};
+
+template<size_t N> void check_wide() {
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+        std::tuple<Leaf<N, Is>...> leaves;
+        auto index = [](const Wide<N>& w) {
+            return fe::visit(
+                w, []<size_t I>(const Leaf<N, I>&) { return I; }, [](const Wide<N>&) { return size_t(-1); });
+        };
+        CHECK(((index(std::get<Is>(leaves)) == Is) && ...));
+        CHECK(index(Wide<N>(0)) == size_t(-1));
+    }(std::make_index_sequence<N>());
+}
+} // namespace
+
+TEST_CASE("visit wide") {
+    check_wide<48>();  // switch
+    check_wide<100>(); // table
+}
+
 enum class MyEnum : unsigned {
     A = 1 << 0,
     B = 1 << 1,
@@ -150,3 +364,121 @@ TEST_CASE("enum") {
     static_assert((MyEnum::A | MyEnum::B) == 3);
     static_assert((MyEnum::A ^ MyEnum::A) == 0);
 }
+
+TEST_CASE("format") {
+    fe::SymPool syms;
+    const std::filesystem::path path = "dir/file.let";
+    auto loc                         = fe::Loc(&path, {1, 2}, {3, 4});
+    CHECK(fe::format::format("{}", fe::Pos()) == "<unknown position>");
+    CHECK(fe::format::format("{}", fe::Pos(7)) == "7");
+    CHECK(fe::format::format("{}", loc) == "dir/file.let:1:2-3:4");
+    CHECK(fe::format::format("{}", loc.anew_begin()) == "dir/file.let:1:2");
+    CHECK(fe::format::format("{}", fe::Loc({1, 2}, {1, 2})) == "<unknown file>:1:2");
+    CHECK(fe::format::format("{}", fe::Loc()) == "<unknown location>");
+    CHECK(fe::format::format("[{:>6}]", fe::Pos(1, 2)) == "[   1:2]");
+    CHECK(fe::format::format("[{:<8}]", syms.sym("abcdefghij")) == "[abcdefghij]");
+    CHECK(fe::format::format("[{:<8}]", syms.sym("abc")) == "[abc     ]");
+}
+
+TEST_CASE("format direct") {
+    auto tab = fe::Tab("  ", 2);
+    CHECK(fe::format::format("{}x", tab) == "    x");
+    CHECK(fe::format::format("{}x", ++tab) == "      x");
+    CHECK(fe::format::format("[{:>4}]", fe::Tab("-", 2)) == "[  --]");
+    CHECK(fe::format::format("{}{}{}{}", fe::utf8::Char32(U'a'), fe::utf8::Char32(U'λ'), fe::utf8::Char32(U'€'),
+                             fe::utf8::Char32(U'𐄂'))
+          == "aλ€𐄂");
+}
+
+TEST_CASE("Writer") {
+    std::ostringstream os;
+    fe::Tab tab("  ");
+    {
+        fe::Writer w(os, 16);
+        w.outln("{}fn {}() {{", tab++, "f");
+        CHECK(os.str().empty());
+        w.indent(tab).outln("return {};", 23);
+        CHECK(os.str() == "fn f() {\n  return 23;\n");
+        CHECK(w.view().empty());
+        w.out("{}}}", --tab).write('\n');
+        CHECK(w.view() == "}\n");
+    }
+    CHECK(os.str() == "fn f() {\n  return 23;\n}\n");
+
+    fe::Writer mem;
+    mem.indent(fe::Tab("\t", 3)).write("x");
+    mem.flush();
+    CHECK(mem.view() == "\t\t\tx");
+    CHECK(fe::Tab("ab", 2).str() == "abab");
+    CHECK(fe::Tab("ab", 1).str() == "ab");
+    CHECK(fe::Tab("-", 3).str() == "---");
+}
+
+TEST_CASE("Fragments") {
+    auto print = [](size_t i, fe::Writer& w, fe::Tab& tab) {
+        w.outln("{}fn f{}() {{", tab++, i);
+        for (size_t j = 0; j != i % 7; ++j) w.outln("{}x{} = {};", tab, j, i * j);
+        w.outln("{}}}", --tab);
+    };
+
+    std::ostringstream serial, parallel;
+    fe::Writer w(serial);
+    for (size_t i = 0; i != 100; ++i) {
+        fe::Tab tab(" ", 1);
+        print(i, w, tab);
+    }
+    w.flush();
+
+    fe::Fragments fragments(100, fe::Tab(" ", 1));
+    fragments.render(print, 4);
+    fragments.write(parallel);
+    CHECK(serial.str() == parallel.str());
+
+    fe::Fragments failing(10);
+    bool thrown = false;
+    try {
+        failing.render([](size_t i, fe::Writer&, fe::Tab&) {
+            if (i == 3) throw std::runtime_error("boom");
+        });
+    } catch (const std::runtime_error&) { thrown = true; }
+    CHECK(thrown);
+}
+
+#ifdef FE_ARENA_PROFILE
+TEST_CASE("Arena profile") {
+    struct Node {
+        uint64_t a, b;
+    };
+
+    fe::Arena arena;
+    for (int i = 0; i != 3; ++i) auto node = arena.mk<Node>();
+    (void)arena.allocate<uint32_t>(10);
+    (void)arena.allocate(5);
+
+    auto report = arena.profile().report();
+    REQUIRE(report.size() == 3);
+    CHECK(report[0].type.ends_with("Node"));
+    CHECK(report[0].num_bytes == 3 * sizeof(Node));
+    CHECK(report[0].num_allocs == 3);
+    CHECK(report[1].type == "unsigned int");
+    CHECK(report[1].num_elems == 10);
+    CHECK(report[2].type == "<untagged>");
+    CHECK(report[2].num_bytes == 5);
+    CHECK(arena.profile().total == 3 * sizeof(Node) + 10 * sizeof(uint32_t) + 5);
+
+    // speculative allocations that are given back again don't count as live
+    auto total = arena.profile().total;
+    auto state = arena.state();
+    (void)arena.allocate<Node>(4);
+    (void)arena.allocate(7);
+    arena.deallocate(state);
+    (void)arena.allocate(3);
+    arena.deallocate(3);
+    CHECK(arena.profile().total == total);
+    CHECK(arena.profile().rolled_back == 4 * sizeof(Node) + 7 + 3);
+    CHECK(arena.state() == state);
+    report = arena.profile().report();
+    CHECK(report[0].num_bytes == 7 * sizeof(Node));
+    CHECK(report[2].num_bytes == 5 + 7 + 3);
+}
+#endif